@@ -1,8 +1,16 @@
+#pragma once
+
 #include <iterator>
 
 
 /**
  * A random access iterator which jumps to another item at a definable distance.
+ *
+ * The position is kept as an iterator and an offset from it. The end of a
+ * skipping range usually lies past the end of the underlying list, and only
+ * the offset ever goes there, so the iterator itself stays valid. This keeps
+ * the SkipIterator usable in constant expressions, where moving a pointer out
+ * of its array is an error.
  */
 template<class RandAccessIterator>
 class SkipIterator {
@@ -18,6 +26,7 @@ public:
 
 private:
     RandAccessIterator iter;
+    difference_type offset;
     difference_type spacing;
 
 public:
@@ -26,104 +35,131 @@ public:
      *
      * @param spacing The skip distance.
      */
-    explicit SkipIterator(difference_type spacing = 1);
+    explicit constexpr SkipIterator(difference_type spacing = 1);
     /**
      * Constructs a SkipIterator with an initial location and spacing.
      *
      * @param iterator The initial location.
      * @param spacing The skip distance.
      */
-    SkipIterator(RandAccessIterator iterator, difference_type spacing = 1);
+    constexpr SkipIterator(
+        RandAccessIterator iterator, difference_type spacing = 1
+    );
     /**
      * A copy constructor.
      *
      * @param iterator The iterator to copy.
      */
-    SkipIterator(const SkipIterator & iterator);
-
-    reference operator*(void) const;
-    SkipIterator operator+(int) const;
-    SkipIterator & operator++(void);
-    SkipIterator operator++(int);
-    SkipIterator & operator+=(difference_type);
-    SkipIterator operator-(int) const;
-    difference_type operator-(SkipIterator) const;
-    SkipIterator & operator--(void);
-    SkipIterator operator--(int);
-    SkipIterator & operator-=(difference_type);
-    bool operator!=(SkipIterator &) const;
-    bool operator<(SkipIterator &) const;
-    bool operator<=(SkipIterator &) const;
-    bool operator==(SkipIterator &) const;
-    bool operator>(SkipIterator &) const;
-    bool operator>=(SkipIterator &) const;
-    reference operator[](difference_type) const;
+    constexpr SkipIterator(const SkipIterator & iterator);
+    /**
+     * A copy assignment operator.
+     *
+     * @param iterator The iterator to copy.
+     * @return This iterator.
+     */
+    constexpr SkipIterator & operator=(const SkipIterator & iterator);
+
+    constexpr reference operator*(void) const;
+    constexpr SkipIterator operator+(int) const;
+    constexpr SkipIterator & operator++(void);
+    constexpr SkipIterator operator++(int);
+    constexpr SkipIterator & operator+=(difference_type);
+    constexpr SkipIterator operator-(int) const;
+    constexpr difference_type operator-(const SkipIterator &) const;
+    constexpr SkipIterator & operator--(void);
+    constexpr SkipIterator operator--(int);
+    constexpr SkipIterator & operator-=(difference_type);
+    constexpr bool operator!=(const SkipIterator &) const;
+    constexpr bool operator<(const SkipIterator &) const;
+    constexpr bool operator<=(const SkipIterator &) const;
+    constexpr bool operator==(const SkipIterator &) const;
+    constexpr bool operator>(const SkipIterator &) const;
+    constexpr bool operator>=(const SkipIterator &) const;
+    constexpr reference operator[](difference_type) const;
 
     /**
      * @return The underlying non-skipping iterator.
      */
-    const RandAccessIterator & get(void) const;
+    constexpr RandAccessIterator get(void) const;
     /**
      * @return The skip distance.
      */
-    const difference_type & getSpacing(void) const;
+    constexpr const difference_type & getSpacing(void) const;
     /**
      * Sets the position of the iterator.
      *
      * @param iterator An iterator at the position.
      */
-    void set(const RandAccessIterator & iterator);
+    constexpr void set(const RandAccessIterator & iterator);
     /**
      * @param spacing The skip distance.
      */
-    void setSpacing(const difference_type & spacing);
+    constexpr void setSpacing(const difference_type & spacing);
+
+private:
+    /**
+     * @param other Another iterator over the same list.
+     * @return The distance from the other iterator in the underlying list.
+     */
+    constexpr difference_type distance(const SkipIterator & other) const;
 };
 
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>::SkipIterator(
+constexpr SkipIterator<RandAccessIterator>::SkipIterator(
     typename std::iterator_traits<RandAccessIterator>::difference_type spacing
-): iter(), spacing(spacing) {
+): iter(), offset(0), spacing(spacing) {
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>::SkipIterator(
+constexpr SkipIterator<RandAccessIterator>::SkipIterator(
     RandAccessIterator iterator,
     typename std::iterator_traits<RandAccessIterator>::difference_type spacing
 ):
-    iter(iterator), spacing(spacing)
+    iter(iterator), offset(0), spacing(spacing)
 {
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>::SkipIterator(
+constexpr SkipIterator<RandAccessIterator>::SkipIterator(
     const SkipIterator<RandAccessIterator> & iterator
-): iter(iterator.iter), spacing(iterator.spacing) {
+): iter(iterator.iter), offset(iterator.offset), spacing(iterator.spacing) {
 }
 
 template<class RandAccessIterator>
-typename SkipIterator<RandAccessIterator>::reference
+constexpr SkipIterator<RandAccessIterator> &
+SkipIterator<RandAccessIterator>::operator=(
+    const SkipIterator<RandAccessIterator> & iterator
+) {
+    iter = iterator.iter;
+    offset = iterator.offset;
+    spacing = iterator.spacing;
+    return *this;
+}
+
+template<class RandAccessIterator>
+constexpr typename SkipIterator<RandAccessIterator>::reference
 SkipIterator<RandAccessIterator>::operator*(void) const {
-    return *iter;
+    return iter[offset];
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>
+constexpr SkipIterator<RandAccessIterator>
 SkipIterator<RandAccessIterator>::operator+(int amount) const {
     SkipIterator<RandAccessIterator> copy(*this);
-    copy.iter += amount * copy.spacing;
+    copy.offset += amount * copy.spacing;
     return copy;
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator> &
+constexpr SkipIterator<RandAccessIterator> &
 SkipIterator<RandAccessIterator>::operator++(void) {
-    iter += spacing;
+    offset += spacing;
     return *this;
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>
+constexpr SkipIterator<RandAccessIterator>
 SkipIterator<RandAccessIterator>::operator++(int) {
     SkipIterator<RandAccessIterator> copy(*this);
     operator++();
@@ -131,39 +167,39 @@ SkipIterator<RandAccessIterator>::operator++(int) {
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator> &
+constexpr SkipIterator<RandAccessIterator> &
 SkipIterator<RandAccessIterator>::operator+=(
     typename SkipIterator<RandAccessIterator>::difference_type amount
 ) {
-    iter += amount * spacing;
+    offset += amount * spacing;
     return *this;
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>
+constexpr SkipIterator<RandAccessIterator>
 SkipIterator<RandAccessIterator>::operator-(int amount) const {
     SkipIterator<RandAccessIterator> copy(*this);
-    copy.iter -= amount * copy.spacing;
+    copy.offset -= amount * copy.spacing;
     return copy;
 }
 
 template<class RandAccessIterator>
-typename SkipIterator<RandAccessIterator>::difference_type
+constexpr typename SkipIterator<RandAccessIterator>::difference_type
 SkipIterator<RandAccessIterator>::operator-(
-    SkipIterator<RandAccessIterator> other
+    const SkipIterator<RandAccessIterator> & other
 ) const {
-    return (iter - other.iter) / spacing;
+    return distance(other) / spacing;
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator> &
+constexpr SkipIterator<RandAccessIterator> &
 SkipIterator<RandAccessIterator>::operator--(void) {
-    iter -= spacing;
+    offset -= spacing;
     return *this;
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>
+constexpr SkipIterator<RandAccessIterator>
 SkipIterator<RandAccessIterator>::operator--(int) {
     SkipIterator<RandAccessIterator> copy(*this);
     operator--();
@@ -171,72 +207,85 @@ SkipIterator<RandAccessIterator>::operator--(int) {
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator> &
+constexpr SkipIterator<RandAccessIterator> &
 SkipIterator<RandAccessIterator>::operator-=(
     typename SkipIterator<RandAccessIterator>::difference_type amount
 ) {
-    iter -= amount * spacing;
+    offset -= amount * spacing;
     return *this;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator!=(SkipIterator & other) const {
-    return iter != other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator!=(
+    const SkipIterator & other
+) const {
+    return distance(other) != 0;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator<(SkipIterator & other) const {
-    return iter < other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator<(
+    const SkipIterator & other
+) const {
+    return distance(other) < 0;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator<=(SkipIterator & other) const {
-    return iter < other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator<=(
+    const SkipIterator & other
+) const {
+    return distance(other) <= 0;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator==(SkipIterator & other) const {
-    return iter == other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator==(
+    const SkipIterator & other
+) const {
+    return distance(other) == 0;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator>(SkipIterator & other) const {
-    return iter > other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator>(
+    const SkipIterator & other
+) const {
+    return distance(other) > 0;
 }
 
 template<class RandAccessIterator>
-bool SkipIterator<RandAccessIterator>::operator>=(SkipIterator & other) const {
-    return iter >= other.iter;
+constexpr bool SkipIterator<RandAccessIterator>::operator>=(
+    const SkipIterator & other
+) const {
+    return distance(other) >= 0;
 }
 
 template<class RandAccessIterator>
-typename SkipIterator<RandAccessIterator>::reference
+constexpr typename SkipIterator<RandAccessIterator>::reference
 SkipIterator<RandAccessIterator>::operator[](
-    typename SkipIterator<RandAccessIterator>::difference_type offset
+    typename SkipIterator<RandAccessIterator>::difference_type index
 ) const {
-    return iter[offset * spacing];
+    return iter[offset + index * spacing];
 }
 
 template<class RandAccessIterator>
-const RandAccessIterator & SkipIterator<RandAccessIterator>::get(void) const {
-    return iter;
+constexpr RandAccessIterator SkipIterator<RandAccessIterator>::get(void) const {
+    return iter + offset;
 }
 
 template<class RandAccessIterator>
-const typename std::iterator_traits<RandAccessIterator>::difference_type &
+constexpr const typename SkipIterator<RandAccessIterator>::difference_type &
 SkipIterator<RandAccessIterator>::getSpacing(void) const {
     return spacing;
 }
 
 template<class RandAccessIterator>
-void SkipIterator<RandAccessIterator>::set(
+constexpr void SkipIterator<RandAccessIterator>::set(
     const RandAccessIterator & iterator
 ) {
     iter = iterator;
+    offset = 0;
 }
 
 template<class RandAccessIterator>
-void
+constexpr void
 SkipIterator<RandAccessIterator>::setSpacing(
     const typename std::iterator_traits<RandAccessIterator>::difference_type & spacing
 ) {
@@ -244,10 +293,15 @@ SkipIterator<RandAccessIterator>::setSpacing(
 }
 
 template<class RandAccessIterator>
-SkipIterator<RandAccessIterator>
+constexpr typename SkipIterator<RandAccessIterator>::difference_type
+SkipIterator<RandAccessIterator>::distance(
+    const SkipIterator<RandAccessIterator> & other
+) const {
+    return (iter - other.iter) + (offset - other.offset);
+}
+
+template<class RandAccessIterator>
+constexpr SkipIterator<RandAccessIterator>
 operator+(int amount, SkipIterator<RandAccessIterator> skip_iterator) {
-    return SkipIterator<RandAccessIterator>(
-        skip_iterator.get() + amount * skip_iterator.getSpacing(),
-        skip_iterator.getSpacing()
-    );
+    return skip_iterator + amount;
 }
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+
+namespace {
+
+/**
+ * The longest lists which have a sorting network.
+ */
+constexpr std::size_t network_sort_limit = 8;
+
+/**
+ * Optimal sorting networks for 2 to 8 elements, as pairs of positions to
+ * compare and exchange.
+ */
+constexpr std::pair<int, int> sorting_network_pairs[] = {
+    // 2
+    {0, 1},
+    // 3
+    {1, 2}, {0, 2}, {0, 1},
+    // 4
+    {0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2},
+    // 5
+    {0, 1}, {3, 4}, {2, 4}, {2, 3}, {1, 4}, {0, 3}, {0, 2}, {1, 3}, {1, 2},
+    // 6
+    {1, 2}, {4, 5}, {0, 2}, {3, 5}, {0, 1}, {3, 4}, {2, 5}, {0, 3}, {1, 4},
+    {2, 4}, {1, 3}, {2, 3},
+    // 7
+    {1, 2}, {3, 4}, {5, 6}, {0, 2}, {3, 5}, {4, 6}, {0, 1}, {4, 5}, {2, 6},
+    {0, 4}, {1, 5}, {0, 3}, {2, 5}, {1, 3}, {2, 4}, {2, 3},
+    // 8
+    {0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {1, 2},
+    {5, 6}, {0, 4}, {3, 7}, {1, 5}, {2, 6}, {1, 4}, {3, 6}, {2, 4}, {3, 5},
+    {3, 4},
+};
+
+/**
+ * The network for n elements is sorting_network_pairs[sorting_networks[n]]
+ * up to sorting_network_pairs[sorting_networks[n + 1]].
+ */
+constexpr int sorting_networks[] = {0, 0, 0, 1, 4, 9, 18, 30, 46, 65};
+
+/**
+ * Orders two arithmetic values without branching.
+ */
+template<class T>
+void compareExchange(T & a, T & b, std::true_type) {
+    const T low = b < a ? b : a;
+    const T high = b < a ? a : b;
+    a = low;
+    b = high;
+}
+
+/**
+ * Orders two values.
+ */
+template<class T>
+void compareExchange(T & a, T & b, std::false_type) {
+    if (b < a) {
+        std::swap(a, b);
+    }
+}
+
+/**
+ * Sorts a short list with the sorting network for its length.
+ *
+ * The comparisons are fixed at compile time, so the loop is unrolled and each
+ * exchange compiles to conditional moves for simple types.
+ *
+ * @param front An iterator to the front of the list.
+ */
+template<std::size_t length, class RandAccessIterator>
+void networkSort(RandAccessIterator front) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    constexpr int network_front = sorting_networks[length];
+    constexpr int network_back = sorting_networks[length + 1];
+    for (int i = network_front; i < network_back; ++i) {
+        compareExchange(
+            front[sorting_network_pairs[i].first],
+            front[sorting_network_pairs[i].second],
+            std::is_arithmetic<value_type>()
+        );
+    }
+}
+
+/**
+ * Sorts a short list with a sorting network.
+ *
+ * @param front An iterator to the front of the list.
+ * @param length The list length, at most network_sort_limit.
+ */
+template<class RandAccessIterator>
+void networkSort(RandAccessIterator front, std::size_t length) {
+    switch (length) {
+        case 2: networkSort<2>(front); break;
+        case 3: networkSort<3>(front); break;
+        case 4: networkSort<4>(front); break;
+        case 5: networkSort<5>(front); break;
+        case 6: networkSort<6>(front); break;
+        case 7: networkSort<7>(front); break;
+        case 8: networkSort<8>(front); break;
+    }
+}
+
+} // namespace
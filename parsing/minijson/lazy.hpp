@@ -0,0 +1,419 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "minijson.hpp"
+
+
+namespace minijson {
+
+/**
+ * A handle to an item in JSON text which is parsed on demand.
+ *
+ * Nothing is parsed until it is accessed. Looking up a list item or object
+ * value only parses the keys along the way. Every other item is skipped by
+ * balancing brackets and quotes, which is much cheaper than parsing it. Only
+ * the parts which are accessed or skipped are checked for errors.
+ *
+ * A LazyValue refers to the text, which must outlive it.
+ */
+class LazyValue {
+
+private:
+    std::string_view text;
+    /**
+     * The index of the item's first character.
+     */
+    std::size_t index;
+
+public:
+    /**
+     * Constructs a handle to an item.
+     *
+     * @param text The JSON text.
+     * @param index The index of the item's first character.
+     */
+    LazyValue(std::string_view text, std::size_t index);
+
+    /**
+     * @throws std::invalid_argument If the item is not valid.
+     */
+    Type type(void) const;
+    bool isInteger(void) const;
+    bool isReal(void) const;
+    bool isString(void) const;
+    bool isList(void) const;
+    bool isObject(void) const;
+
+    /**
+     * @return The integer.
+     * @throws std::invalid_argument If the item is not an integer.
+     */
+    long asInteger(void) const;
+    /**
+     * @return The number as a double.
+     * @throws std::invalid_argument If the item is not a number.
+     */
+    double asReal(void) const;
+    /**
+     * @return The string.
+     * @throws std::invalid_argument If the item is not a string.
+     */
+    std::string_view asString(void) const;
+
+    /**
+     * Counts the list items or object key-value pairs.
+     *
+     * @throws std::invalid_argument If the item is not a list or object.
+     */
+    std::size_t size(void) const;
+    /**
+     * @param i The item index.
+     * @return The ith list item.
+     * @throws std::invalid_argument If the item is not a list.
+     * @throws std::out_of_range If the list is too short.
+     */
+    LazyValue operator[](std::size_t i) const;
+    /**
+     * Finds an object value by its string key.
+     *
+     * @param key The key.
+     * @return The value of the first pair with the key.
+     * @throws std::invalid_argument If the item is not an object.
+     * @throws std::out_of_range If there is no such key.
+     */
+    LazyValue operator[](std::string_view key) const;
+
+private:
+    /**
+     * Checks that the item starts with a character.
+     *
+     * @throws std::invalid_argument If it does not.
+     */
+    void expect(char c, const char * type_name) const;
+    /**
+     * Visits each item of a list or each key-value pair of an object.
+     *
+     * @param visit Receives the index of each item or key, and returns whether
+     * to stop.
+     * @return The index where visiting stopped, or npos if all were visited.
+     */
+    template<class Visitor>
+    std::size_t forEach(Visitor visit) const;
+};
+
+
+namespace {
+
+/**
+ * Throws an std::invalid_argument for an unexpected token in lazy text.
+ */
+[[noreturn]] void throwUnexpectedToken(std::string_view text, std::size_t i) {
+    throw std::invalid_argument(
+        i < text.size()
+        ? "Unexpected token " + std::string(1, text[i]) + " at index "
+            + std::to_string(i)
+        : std::string("Unexpectedly reached end of string")
+    );
+}
+
+std::size_t skipWs(std::string_view text, std::size_t i) {
+    while (i < text.size() && isWs(text[i])) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * Finds the end of a string.
+ *
+ * @param i The index of the opening quote.
+ * @return The index after the closing quote.
+ */
+std::size_t skipString(std::string_view text, std::size_t i) {
+    const std::size_t close = text.find('"', i + 1);
+    if (close == std::string_view::npos) {
+        throwUnexpectedToken(text, text.size());
+    }
+    return close + 1;
+}
+
+/**
+ * Marks the characters which skipValue() must stop at.
+ */
+constexpr struct SkipStops {
+    bool stops[256] = {};
+
+    constexpr SkipStops() {
+        for (const char c : {'"', '[', ']', '{', '}'}) {
+            stops[static_cast<unsigned char>(c)] = true;
+        }
+    }
+
+    constexpr bool operator[](unsigned char c) const {
+        return stops[c];
+    }
+} skip_stops;
+
+/**
+ * Finds the end of an item without parsing it.
+ *
+ * Lists and objects are skipped by counting brackets and braces. Strings are
+ * jumped over so brackets inside them are not counted.
+ *
+ * @param i The index of the item's first character.
+ * @return The index after the item.
+ */
+std::size_t skipValue(std::string_view text, std::size_t i) {
+    if (i >= text.size()) {
+        throwUnexpectedToken(text, i);
+    }
+    const char c = text[i];
+    if (c == '"') {
+        return skipString(text, i);
+    }
+    if (isDigit(c) || c == '.') {
+        while (i < text.size() && (isDigit(text[i]) || text[i] == '.')) {
+            ++i;
+        }
+        return i;
+    }
+    if (c != '[' && c != '{') {
+        throwUnexpectedToken(text, i);
+    }
+
+    std::size_t depth = 0;
+    const unsigned char * const data =
+        reinterpret_cast<const unsigned char *>(text.data());
+    while (true) {
+        // Most characters are not brackets or quotes, so pass over them with
+        // one table lookup each.
+        while (i < text.size() && !skip_stops[data[i]]) {
+            ++i;
+        }
+        if (i >= text.size()) {
+            break;
+        }
+        if (data[i] == '"') {
+            i = skipString(text, i);
+            continue;
+        }
+        if (data[i] == '[' || data[i] == '{') {
+            ++depth;
+        } else if (--depth == 0) {
+            return i + 1;
+        }
+        ++i;
+    }
+    throwUnexpectedToken(text, text.size());
+}
+
+} // namespace
+
+
+inline LazyValue::LazyValue(std::string_view text, std::size_t index):
+    text(text), index(index)
+{
+}
+
+inline Type LazyValue::type(void) const {
+    const char c = index < text.size() ? text[index] : '\0';
+    if (c == '"') {
+        return Type::string;
+    }
+    if (c == '[') {
+        return Type::list;
+    }
+    if (c == '{') {
+        return Type::object;
+    }
+    if (isDigit(c) || c == '.') {
+        Node node;
+        scanNumber(text.data() + index, text.data() + text.size(), node);
+        return node.type;
+    }
+    throwUnexpectedToken(text, index);
+}
+
+inline bool LazyValue::isInteger(void) const {
+    return type() == Type::integer;
+}
+
+inline bool LazyValue::isReal(void) const {
+    return type() == Type::real;
+}
+
+inline bool LazyValue::isString(void) const {
+    return type() == Type::string;
+}
+
+inline bool LazyValue::isList(void) const {
+    return type() == Type::list;
+}
+
+inline bool LazyValue::isObject(void) const {
+    return type() == Type::object;
+}
+
+inline long LazyValue::asInteger(void) const {
+    Node node;
+    const char * first = text.data() + index;
+    const char * number_end =
+        scanNumber(first, text.data() + text.size(), node);
+    if (number_end == first || node.type != Type::integer) {
+        throw std::invalid_argument(
+            "Expected integer at index " + std::to_string(index)
+        );
+    }
+    if (!number_end) {
+        throw std::invalid_argument(
+            "Number out of range at index " + std::to_string(index)
+        );
+    }
+    return node.integer;
+}
+
+inline double LazyValue::asReal(void) const {
+    Node node;
+    const char * first = text.data() + index;
+    const char * number_end =
+        scanNumber(first, text.data() + text.size(), node);
+    if (
+        number_end == first
+        || (node.type == Type::real && number_end == first + 1)
+    ) {
+        throw std::invalid_argument(
+            "Expected number at index " + std::to_string(index)
+        );
+    }
+    if (!number_end) {
+        throw std::invalid_argument(
+            "Number out of range at index " + std::to_string(index)
+        );
+    }
+    return node.type == Type::integer ? node.integer : node.real;
+}
+
+inline std::string_view LazyValue::asString(void) const {
+    expect('"', "string");
+    const std::size_t string_end = skipString(text, index);
+    return text.substr(index + 1, string_end - index - 2);
+}
+
+inline std::size_t LazyValue::size(void) const {
+    std::size_t count = 0;
+    forEach([&count](std::size_t) {
+        ++count;
+        return false;
+    });
+    return count;
+}
+
+inline LazyValue LazyValue::operator[](std::size_t i) const {
+    expect('[', "list");
+    const std::size_t item = forEach([&i](std::size_t) {
+        return i-- == 0;
+    });
+    if (item == std::string_view::npos) {
+        throw std::out_of_range("List index out of range");
+    }
+    return LazyValue(text, item);
+}
+
+inline LazyValue LazyValue::operator[](std::string_view key) const {
+    expect('{', "object");
+    const std::size_t key_index = forEach([&](std::size_t i) {
+        if (text[i] != '"') {
+            return false;
+        }
+        return text.compare(i + 1, key.size(), key) == 0
+            && i + 1 + key.size() < text.size()
+            && text[i + 1 + key.size()] == '"';
+    });
+    if (key_index == std::string_view::npos) {
+        throw std::out_of_range("Key " + std::string(key) + " not found");
+    }
+    // Move from the key to the value.
+    const std::size_t colon = skipWs(text, skipValue(text, key_index));
+    return LazyValue(text, skipWs(text, colon + 1));
+}
+
+inline void LazyValue::expect(char c, const char * type_name) const {
+    if (index >= text.size() || text[index] != c) {
+        throw std::invalid_argument(
+            "Expected " + std::string(type_name) + " at index "
+            + std::to_string(index)
+        );
+    }
+}
+
+template<class Visitor>
+std::size_t LazyValue::forEach(Visitor visit) const {
+    if (index >= text.size() || (text[index] != '[' && text[index] != '{')) {
+        throw std::invalid_argument(
+            "Expected list or object at index " + std::to_string(index)
+        );
+    }
+    const bool is_object = text[index] == '{';
+    const char close = is_object ? '}' : ']';
+
+    std::size_t i = skipWs(text, index + 1);
+    bool first = true;
+    while (i >= text.size() || text[i] != close) {
+        if (!first) {
+            if (i >= text.size() || text[i] != ',') {
+                throwUnexpectedToken(text, i);
+            }
+            i = skipWs(text, i + 1);
+        }
+        first = false;
+
+        if (i >= text.size() || text[i] == ',' || text[i] == close) {
+            throwUnexpectedToken(text, i);
+        }
+        if (visit(i)) {
+            return i;
+        }
+        if (is_object) {
+            // Skip the key and colon.
+            if (text[i] == '[' || text[i] == '{') {
+                throwUnexpectedToken(text, i);
+            }
+            i = skipWs(text, skipValue(text, i));
+            if (i >= text.size() || text[i] != ':') {
+                throwUnexpectedToken(text, i);
+            }
+            i = skipWs(text, i + 1);
+        }
+        i = skipWs(text, skipValue(text, i));
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * Prepares the JSON item (object or list) encoded in the given string for
+ * access on demand.
+ *
+ * Only the start of the item is checked. The rest is checked as it is
+ * accessed.
+ *
+ * @param s The JSON text, which must outlive the result.
+ * @return The item, or nothing if the string is only whitespace.
+ * @throws std::invalid_argument If the text does not start with an item.
+ */
+inline std::optional<LazyValue> lazyLoad(std::string_view s) {
+    const std::size_t front = skipWs(s, 0);
+    if (front == s.size()) {
+        return std::nullopt;
+    }
+    if (s[front] != '[' && s[front] != '{') {
+        throwUnexpectedToken(s, front);
+    }
+    return LazyValue(s, front);
+}
+
+} // namespace minijson
@@ -0,0 +1,675 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace minijson {
+
+/**
+ * The kinds of JSON items.
+ */
+enum class Type {
+    integer,
+    real,
+    string,
+    list,
+    object,
+};
+
+/**
+ * One parsed JSON item.
+ *
+ * Items are stored in a flat tape in the order they appear in the text. A list
+ * or object is immediately followed by its contents. Object contents alternate
+ * between keys and values.
+ */
+struct Node {
+    Type type;
+    /**
+     * The number of characters in a string, items in a list, or key-value pairs
+     * in an object.
+     */
+    std::size_t size;
+    union {
+        long integer;
+        double real;
+        /**
+         * The first character of a string, which points into the parsed text.
+         */
+        const char * string;
+        /**
+         * The tape index after the last item of a list or object.
+         */
+        std::size_t end;
+    };
+};
+
+/**
+ * A read-only handle to an item in a Document.
+ *
+ * A Value is invalidated when its document is modified or destroyed.
+ */
+class Value {
+
+private:
+    const Node * tape;
+    std::size_t index;
+
+public:
+    /**
+     * Constructs a handle to an item in a tape.
+     *
+     * @param tape The front of the tape.
+     * @param index The item's index in the tape.
+     */
+    Value(const Node * tape, std::size_t index);
+
+    Type type(void) const;
+    bool isInteger(void) const;
+    bool isReal(void) const;
+    bool isString(void) const;
+    bool isList(void) const;
+    bool isObject(void) const;
+
+    /**
+     * @return The integer. The item must be an integer.
+     */
+    long asInteger(void) const;
+    /**
+     * @return The number as a double. The item must be a number.
+     */
+    double asReal(void) const;
+    /**
+     * @return The string. The item must be a string.
+     */
+    std::string_view asString(void) const;
+
+    /**
+     * @return The string length, list length, or number of key-value pairs.
+     */
+    std::size_t size(void) const;
+    /**
+     * @param i The item index. The item must be a list.
+     * @return The ith list item.
+     */
+    Value operator[](std::size_t i) const;
+    /**
+     * Finds an object value by its string key.
+     *
+     * @param key The key. The item must be an object.
+     * @return The value of the first pair with the key.
+     * @throws std::out_of_range If there is no such key.
+     */
+    Value operator[](std::string_view key) const;
+    /**
+     * @param i The pair index. The item must be an object.
+     * @return The key of the ith key-value pair.
+     */
+    Value key(std::size_t i) const;
+    /**
+     * @param i The pair index. The item must be an object.
+     * @return The value of the ith key-value pair.
+     */
+    Value value(std::size_t i) const;
+
+private:
+    /**
+     * @param i A tape index.
+     * @return The tape index of the item following the item at i and all of
+     * its contents.
+     */
+    std::size_t next(std::size_t i) const;
+};
+
+/**
+ * Storage for parsed JSON items.
+ *
+ * A document can hold several JSON items, one after another, which lets it be
+ * reused as an arena. Clearing it keeps the allocated memory for the next use.
+ * Strings are not copied, so the parsed text must outlive the document.
+ */
+class Document {
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+private:
+    std::vector<Node> tape;
+
+public:
+    /**
+     * Parses a JSON item (object or list) and appends it to the document.
+     *
+     * @param s The JSON text.
+     * @return The index of the item, or npos if the text is only whitespace.
+     * @throws std::invalid_argument If the text is not valid JSON.
+     */
+    std::size_t append(std::string_view s);
+    /**
+     * @param index An index returned by append().
+     * @return The item.
+     */
+    Value at(std::size_t index) const;
+    /**
+     * Removes all items from the document.
+     */
+    void clear(void);
+    /**
+     * @return Whether the document contains no items.
+     */
+    bool empty(void) const;
+};
+
+
+namespace {
+
+/**
+ * A cursor within a string.
+ */
+class Cursor {
+
+public:
+    const std::string_view string;
+
+private:
+    std::size_t index_;
+
+public:
+    /**
+     * Creates a cursor for the string at an index.
+     */
+    Cursor(std::string_view string, std::size_t index):
+        string(string), index_(index)
+    {
+    }
+
+    std::size_t index(void) const {
+        return index_;
+    }
+
+    bool isEnd(void) const {
+        return index_ == string.size();
+    }
+
+    /**
+     * Returns the next character and advances the cursor.
+     */
+    char next(void) {
+        const char c = peek();
+        if (!isEnd()) {
+            ++index_;
+        }
+        return c;
+    }
+
+    /**
+     * Advances the cursor by a number of characters.
+     */
+    void skip(std::size_t count) {
+        index_ += count;
+    }
+
+    /**
+     * Returns the next character without affecting the cursor, or '\0' at the
+     * end.
+     */
+    char peek(void) const {
+        return isEnd() ? '\0' : string.data()[index_];
+    }
+};
+
+/**
+ * Throws an std::invalid_argument if the cursor has reached the end.
+ */
+void assertNotEnd(const Cursor & stream) {
+    if (stream.isEnd()) {
+        throw std::invalid_argument("Unexpectedly reached end of string");
+    }
+}
+
+/**
+ * Throws an std::invalid_argument with a message indicating an unexpected
+ * token at the current cursor position.
+ */
+[[noreturn]] void throwUnexpectedToken(const Cursor & stream) {
+    throw std::invalid_argument(
+        "Unexpected token " + std::string(1, stream.peek()) + " at index "
+        + std::to_string(stream.index())
+    );
+}
+
+bool isWs(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Advances the cursor until the next character is not whitespace.
+ */
+void skipWs(Cursor & stream) {
+    while (!stream.isEnd() && isWs(stream.peek())) {
+        stream.next();
+    }
+}
+
+void expr(Cursor & stream, std::vector<Node> & tape);
+
+/**
+ * Parses a JSON string onto the tape.
+ */
+void string(Cursor & stream, std::vector<Node> & tape) {
+    // A string of characters, excluding double quotes, enclosed by double
+    // quotes.
+    stream.next();
+    const std::size_t start = stream.index();
+    while (true) {
+        assertNotEnd(stream);
+        if (stream.next() == '"') {
+            break;
+        }
+    }
+    Node node;
+    node.type = Type::string;
+    node.size = stream.index() - 1 - start;
+    node.string = stream.string.data() + start;
+    tape.push_back(node);
+}
+
+/**
+ * Exact powers of ten for the fast path of scanNumber().
+ */
+constexpr double powers_of_10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * Scans a JSON number and converts it in the same pass.
+ *
+ * Digits are accumulated while scanning. Integers of up to 18 digits are
+ * exact. A decimal number with up to 15 digits is also exact because both the
+ * digits and the power of ten are exactly representable as doubles, so one
+ * division rounds correctly. Longer numbers fall back to std::from_chars().
+ *
+ * @param first The first character of the number.
+ * @param last The end of the text.
+ * @param node Receives the type and value.
+ * @return One past the last character of the number, or nullptr if the number
+ * is out of range.
+ */
+const char * scanNumber(const char * first, const char * last, Node & node) {
+    // A string of digits and up to one decimal character.
+    unsigned long digits = 0;
+    int digit_count = 0;
+    const char * decimal = nullptr;
+    const char * c = first;
+    for (; c < last; ++c) {
+        if (isDigit(*c)) {
+            digits = digits * 10 + (*c - '0');
+            ++digit_count;
+        } else if (*c == '.' && !decimal) {
+            decimal = c;
+        } else {
+            break;
+        }
+        if (digit_count > 18) {
+            break;
+        }
+    }
+
+    node.size = 0;
+    if (digit_count <= 18 && (c == last || !isDigit(*c))) {
+        if (!decimal) {
+            node.type = Type::integer;
+            node.integer = static_cast<long>(digits);
+            return c;
+        }
+        const long fraction_count = c - decimal - 1;
+        if (digit_count <= 15 && fraction_count <= 22) {
+            node.type = Type::real;
+            node.real = digits / powers_of_10[fraction_count];
+            return c;
+        }
+    }
+
+    // Slow path. Finish scanning and let the standard library convert.
+    for (; c < last && (isDigit(*c) || (*c == '.' && !decimal)); ++c) {
+        if (*c == '.') {
+            decimal = c;
+        }
+    }
+    std::from_chars_result result;
+    if (decimal) {
+        node.type = Type::real;
+        result = std::from_chars(first, c, node.real);
+    } else {
+        node.type = Type::integer;
+        result = std::from_chars(first, c, node.integer);
+    }
+    return result.ec == std::errc() ? c : nullptr;
+}
+
+/**
+ * Parses a JSON number onto the tape.
+ */
+void number(Cursor & stream, std::vector<Node> & tape) {
+    const std::size_t start = stream.index();
+    const char * first = stream.string.data() + start;
+    const char * last = stream.string.data() + stream.string.size();
+    Node node;
+    const char * number_end = scanNumber(first, last, node);
+    if (!number_end) {
+        throw std::invalid_argument(
+            "Number out of range at index " + std::to_string(start)
+        );
+    }
+    stream.skip(number_end - first);
+    if (node.type == Type::real && number_end - first == 1) {
+        throwUnexpectedToken(stream);
+    }
+    tape.push_back(node);
+}
+
+/**
+ * Parses a JSON list onto the tape.
+ */
+void list(Cursor & stream, std::vector<Node> & tape) {
+    // A left bracket, followed by a string of comma-separated expressions with
+    // optional whitespace around items, followed by a right bracket.
+    stream.next();
+    const std::size_t list_index = tape.size();
+    tape.emplace_back();
+    std::size_t size = 0;
+    skipWs(stream);
+    assertNotEnd(stream);
+    if (stream.peek() == ',') {
+        throwUnexpectedToken(stream);
+    }
+    while (stream.peek() != ']') {
+        if (size > 0) {
+            if (stream.peek() != ',') {
+                throwUnexpectedToken(stream);
+            }
+            stream.next();
+            skipWs(stream);
+        }
+        expr(stream, tape);
+        ++size;
+        skipWs(stream);
+        assertNotEnd(stream);
+    }
+    stream.next();
+    tape[list_index].type = Type::list;
+    tape[list_index].size = size;
+    tape[list_index].end = tape.size();
+}
+
+/**
+ * Parses a JSON object key/field onto the tape.
+ */
+void key(Cursor & stream, std::vector<Node> & tape) {
+    // An expression, excluding objects and lists.
+    assertNotEnd(stream);
+    const char c = stream.peek();
+    if (c == '[' || c == '{') {
+        throwUnexpectedToken(stream);
+    }
+    expr(stream, tape);
+}
+
+/**
+ * Parses a JSON object value onto the tape.
+ */
+void value(Cursor & stream, std::vector<Node> & tape) {
+    // An expression.
+    expr(stream, tape);
+}
+
+/**
+ * Parses a JSON object key-value pair onto the tape.
+ */
+void keyValue(Cursor & stream, std::vector<Node> & tape) {
+    // A key, optional whitespace, colon, optional whitespace, and value.
+    key(stream, tape);
+    skipWs(stream);
+    assertNotEnd(stream);
+    if (stream.peek() != ':') {
+        throw std::invalid_argument(
+            "Expected \":\" before token " + std::string(1, stream.peek())
+            + " at index " + std::to_string(stream.index())
+        );
+    }
+    stream.next();
+    skipWs(stream);
+    assertNotEnd(stream);
+    value(stream, tape);
+}
+
+/**
+ * Parses a JSON object onto the tape.
+ */
+void object(Cursor & stream, std::vector<Node> & tape) {
+    // A left brace, followed by a string of comma-separated key-value pairs
+    // with optional whitespace around items, followed by a right brace.
+    stream.next();
+    const std::size_t object_index = tape.size();
+    tape.emplace_back();
+    std::size_t size = 0;
+    skipWs(stream);
+    assertNotEnd(stream);
+    if (stream.peek() == ',') {
+        throwUnexpectedToken(stream);
+    }
+    while (stream.peek() != '}') {
+        if (size > 0) {
+            if (stream.peek() != ',') {
+                throwUnexpectedToken(stream);
+            }
+            stream.next();
+            skipWs(stream);
+        }
+        keyValue(stream, tape);
+        ++size;
+        skipWs(stream);
+        assertNotEnd(stream);
+    }
+    stream.next();
+    tape[object_index].type = Type::object;
+    tape[object_index].size = size;
+    tape[object_index].end = tape.size();
+}
+
+/**
+ * Parses a JSON expression onto the tape.
+ */
+void expr(Cursor & stream, std::vector<Node> & tape) {
+    // A string, number, list, or object.
+    assertNotEnd(stream);
+    const char c = stream.peek();
+    if (c == '"') {
+        string(stream, tape);
+    } else if (isDigit(c) || c == '.') {
+        number(stream, tape);
+    } else if (c == '[') {
+        list(stream, tape);
+    } else if (c == '{') {
+        object(stream, tape);
+    } else {
+        throwUnexpectedToken(stream);
+    }
+}
+
+/**
+ * Parses a JSON item (object or list) onto the tape.
+ *
+ * @return Whether there was an item, i.e. the string was not only whitespace.
+ */
+bool json(Cursor & stream, std::vector<Node> & tape) {
+    // A list or object surrounded by optional whitespace.
+    skipWs(stream);
+    if (stream.isEnd()) {
+        return false;
+    }
+    const char c = stream.peek();
+    if (c == '[') {
+        list(stream, tape);
+    } else if (c == '{') {
+        object(stream, tape);
+    } else {
+        throwUnexpectedToken(stream);
+    }
+    skipWs(stream);
+    if (!stream.isEnd()) {
+        throwUnexpectedToken(stream);
+    }
+    return true;
+}
+
+} // namespace
+
+
+inline Value::Value(const Node * tape, std::size_t index):
+    tape(tape), index(index)
+{
+}
+
+inline Type Value::type(void) const {
+    return tape[index].type;
+}
+
+inline bool Value::isInteger(void) const {
+    return type() == Type::integer;
+}
+
+inline bool Value::isReal(void) const {
+    return type() == Type::real;
+}
+
+inline bool Value::isString(void) const {
+    return type() == Type::string;
+}
+
+inline bool Value::isList(void) const {
+    return type() == Type::list;
+}
+
+inline bool Value::isObject(void) const {
+    return type() == Type::object;
+}
+
+inline long Value::asInteger(void) const {
+    return tape[index].integer;
+}
+
+inline double Value::asReal(void) const {
+    if (isInteger()) {
+        return static_cast<double>(tape[index].integer);
+    }
+    return tape[index].real;
+}
+
+inline std::string_view Value::asString(void) const {
+    return std::string_view(tape[index].string, tape[index].size);
+}
+
+inline std::size_t Value::size(void) const {
+    return tape[index].size;
+}
+
+inline Value Value::operator[](std::size_t i) const {
+    std::size_t item = index + 1;
+    for (; i > 0; --i) {
+        item = next(item);
+    }
+    return Value(tape, item);
+}
+
+inline Value Value::operator[](std::string_view key) const {
+    std::size_t item = index + 1;
+    for (std::size_t i = 0; i < size(); ++i) {
+        const std::size_t value_index = next(item);
+        const Node & key_node = tape[item];
+        if (
+            key_node.type == Type::string
+            && std::string_view(key_node.string, key_node.size) == key
+        ) {
+            return Value(tape, value_index);
+        }
+        item = next(value_index);
+    }
+    throw std::out_of_range("Key " + std::string(key) + " not found");
+}
+
+inline Value Value::key(std::size_t i) const {
+    std::size_t item = index + 1;
+    for (; i > 0; --i) {
+        item = next(next(item));
+    }
+    return Value(tape, item);
+}
+
+inline Value Value::value(std::size_t i) const {
+    return Value(tape, next(key(i).index));
+}
+
+inline std::size_t Value::next(std::size_t i) const {
+    const Type item_type = tape[i].type;
+    if (item_type == Type::list || item_type == Type::object) {
+        return tape[i].end;
+    }
+    return i + 1;
+}
+
+inline std::size_t Document::append(std::string_view s) {
+    const std::size_t root = tape.size();
+    Cursor cursor(s, 0);
+    try {
+        if (!json(cursor, tape)) {
+            return npos;
+        }
+    } catch (...) {
+        // Leave the document as it was.
+        tape.resize(root);
+        throw;
+    }
+    return root;
+}
+
+inline Value Document::at(std::size_t index) const {
+    return Value(tape.data(), index);
+}
+
+inline void Document::clear(void) {
+    tape.clear();
+}
+
+inline bool Document::empty(void) const {
+    return tape.empty();
+}
+
+/**
+ * Parses the JSON item encoded in the given string.
+ *
+ * Strings in the result refer to the given string, which must outlive the
+ * document.
+ *
+ * @param s The JSON text.
+ * @return A document holding the item at index 0, or an empty document if the
+ * string is only whitespace.
+ * @throws std::invalid_argument If the text is not valid JSON.
+ */
+inline Document load(std::string_view s) {
+    Document document;
+    document.append(s);
+    return document;
+}
+
+} // namespace minijson
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "minijson.hpp"
+
+
+namespace minijson {
+
+namespace {
+
+/**
+ * A fixed set of threads which run queued tasks.
+ */
+class WorkerPool {
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping = false;
+
+public:
+    explicit WorkerPool(unsigned threads) {
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    /**
+     * Discards tasks which have not started and waits for running tasks.
+     */
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            tasks.clear();
+        }
+        task_available.notify_all();
+        for (auto & worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        task_available.notify_one();
+    }
+
+private:
+    void work(void) {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                task_available.wait(
+                    lock, [this]() { return stopping || !tasks.empty(); }
+                );
+                if (stopping) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+/**
+ * A chunk of whole records and the result of parsing it.
+ */
+struct Chunk {
+    /**
+     * Owns the text of streamed chunks. Unused for in-memory input.
+     */
+    std::string buffer;
+    std::string_view text;
+    /**
+     * The arena which holds the parsed records.
+     */
+    Document document;
+    std::vector<std::size_t> roots;
+    /**
+     * The number of lines in the chunk.
+     */
+    std::size_t lines = 0;
+    /**
+     * The first error, if any. Only records before it are in roots.
+     */
+    std::exception_ptr error;
+    /**
+     * The line within the chunk where the error occurred.
+     */
+    std::size_t error_line = 0;
+    bool done = false;
+};
+
+/**
+ * Parses every line of a chunk into its document.
+ */
+void parseChunk(Chunk & chunk) {
+    std::size_t line_front = 0;
+    while (line_front < chunk.text.size()) {
+        std::size_t line_back = chunk.text.find('\n', line_front);
+        if (line_back == std::string_view::npos) {
+            line_back = chunk.text.size();
+        }
+        try {
+            const std::size_t root = chunk.document.append(
+                chunk.text.substr(line_front, line_back - line_front)
+            );
+            if (root != Document::npos) {
+                chunk.roots.push_back(root);
+            }
+        } catch (...) {
+            chunk.error = std::current_exception();
+            chunk.error_line = chunk.lines;
+            return;
+        }
+        ++chunk.lines;
+        line_front = line_back + 1;
+    }
+}
+
+/**
+ * Dispatches chunks to a pool of threads and delivers their records in order.
+ *
+ * @param threads The number of threads.
+ * @param read Fills a chunk's text with the next whole lines. Returns false
+ * when the input is exhausted.
+ * @param callback Receives each record in order.
+ */
+template<class Reader>
+void parseChunks(
+    unsigned threads,
+    Reader read,
+    const std::function<void(Value)> & callback
+) {
+    // Two chunks per thread keeps the threads busy while records are being
+    // delivered.
+    std::vector<Chunk> chunks(2 * threads);
+    std::mutex mutex;
+    std::condition_variable chunk_done;
+    // Declared after the chunks so in-flight tasks finish before the chunks
+    // are destroyed.
+    WorkerPool pool(threads);
+
+    std::size_t dispatched = 0;
+    std::size_t delivered = 0;
+    std::size_t line_base = 0;
+    bool input_left = true;
+
+    while (true) {
+        // Fill every free slot.
+        while (input_left && dispatched - delivered < chunks.size()) {
+            Chunk & chunk = chunks[dispatched % chunks.size()];
+            chunk.document.clear();
+            chunk.roots.clear();
+            chunk.lines = 0;
+            chunk.error = nullptr;
+            chunk.done = false;
+            input_left = read(chunk);
+            if (!input_left) {
+                break;
+            }
+            pool.submit([&chunk, &mutex, &chunk_done]() {
+                parseChunk(chunk);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    chunk.done = true;
+                }
+                chunk_done.notify_all();
+            });
+            ++dispatched;
+        }
+        if (delivered == dispatched) {
+            break;
+        }
+
+        // Deliver the oldest chunk.
+        Chunk & chunk = chunks[delivered % chunks.size()];
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunk_done.wait(lock, [&chunk]() { return chunk.done; });
+        }
+        for (const std::size_t root : chunk.roots) {
+            callback(chunk.document.at(root));
+        }
+        if (chunk.error) {
+            try {
+                std::rethrow_exception(chunk.error);
+            } catch (const std::exception & e) {
+                throw std::invalid_argument(
+                    "Line " + std::to_string(line_base + chunk.error_line + 1)
+                    + ": " + e.what()
+                );
+            }
+        }
+        line_base += chunk.lines;
+        ++delivered;
+    }
+}
+
+} // namespace
+
+
+/**
+ * A parallel parser for newline-delimited JSON (one JSON item per line).
+ *
+ * The input is split into chunks at line boundaries. Chunks are parsed on a
+ * pool of threads, each into its own reusable document, and the records are
+ * delivered in their original order. At most a fixed number of chunks are in
+ * flight, so memory use is bounded regardless of the input size.
+ */
+class NdjsonParser {
+
+public:
+    /**
+     * The function which receives each record. The value is only valid during
+     * the call.
+     */
+    using Callback = std::function<void(Value)>;
+
+private:
+    unsigned threads;
+    std::size_t chunk_size;
+
+public:
+    /**
+     * Constructs a parser.
+     *
+     * @param threads The number of parsing threads. Zero means one per
+     * hardware thread.
+     * @param chunk_size The approximate number of bytes in a chunk.
+     */
+    explicit NdjsonParser(
+        unsigned threads = 0, std::size_t chunk_size = 1 << 20
+    );
+
+    /**
+     * Parses in-memory (e.g. memory-mapped) text.
+     *
+     * Blank lines are skipped.
+     *
+     * @param text The text.
+     * @param callback Receives each record in order.
+     * @throws std::invalid_argument If a line is not valid JSON. The records
+     * before it are delivered first.
+     */
+    void parse(std::string_view text, const Callback & callback) const;
+    /**
+     * Parses text from a stream.
+     *
+     * @see parse(std::string_view, const Callback &) const
+     */
+    void parse(std::istream & stream, const Callback & callback) const;
+};
+
+
+inline NdjsonParser::NdjsonParser(unsigned threads, std::size_t chunk_size):
+    threads(threads), chunk_size(chunk_size)
+{
+    if (this->threads == 0) {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->chunk_size == 0) {
+        this->chunk_size = 1;
+    }
+}
+
+inline void NdjsonParser::parse(
+    std::string_view text, const Callback & callback
+) const {
+    std::size_t front = 0;
+    parseChunks(threads, [&](Chunk & chunk) {
+        if (front >= text.size()) {
+            return false;
+        }
+        // Extend the chunk to the end of its last line.
+        std::size_t back = front + chunk_size;
+        if (back >= text.size()) {
+            back = text.size();
+        } else {
+            back = text.find('\n', back);
+            back = back == std::string_view::npos ? text.size() : back + 1;
+        }
+        chunk.text = text.substr(front, back - front);
+        front = back;
+        return true;
+    }, callback);
+}
+
+inline void NdjsonParser::parse(
+    std::istream & stream, const Callback & callback
+) const {
+    std::string carry; // The incomplete last line of the previous read.
+    parseChunks(threads, [&](Chunk & chunk) {
+        chunk.buffer.swap(carry);
+        carry.clear();
+        while (true) {
+            // Append the next block after the carried over part.
+            const std::size_t old_size = chunk.buffer.size();
+            chunk.buffer.resize(old_size + chunk_size);
+            stream.read(&chunk.buffer[old_size], chunk_size);
+            chunk.buffer.resize(old_size + stream.gcount());
+            if (!stream) {
+                break;
+            }
+            // Hold back the incomplete last line, if there is a full line.
+            const std::size_t last_newline = chunk.buffer.rfind('\n');
+            if (last_newline != std::string::npos) {
+                carry.assign(chunk.buffer, last_newline + 1);
+                chunk.buffer.resize(last_newline + 1);
+                break;
+            }
+        }
+        chunk.text = chunk.buffer;
+        return !chunk.buffer.empty();
+    }, callback);
+}
+
+} // namespace minijson
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "lazy.hpp"
+#include "minijson.hpp"
+#include "ndjson.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 8;
+    constexpr int time_width = 14;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::endl;
+}
+
+bool throwsInvalidArgument(const std::string & json) {
+    try {
+        minijson::load(json);
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Creates newline-delimited JSON records.
+ *
+ * @param size The approximate number of bytes.
+ * @param history_size The number of extra items in each record's history.
+ * @return The records.
+ */
+std::string randomNdjson(std::size_t size, int history_size = 0) {
+    std::default_random_engine r_engine;
+    std::uniform_int_distribution<int> r_distr(0, 1000000);
+    std::string text;
+    text.reserve(size + 256);
+
+    long id = 0;
+    while (text.size() < size) {
+        text += "{\"id\": " + std::to_string(id++)
+            + ", \"name\": \"user" + std::to_string(r_distr(r_engine))
+            + "\", \"score\": " + std::to_string(r_distr(r_engine)) + "."
+            + std::to_string(r_distr(r_engine) % 100)
+            + ", \"tags\": [\"a\", \"b\", " + std::to_string(r_distr(r_engine))
+            + "], \"history\": [";
+        for (int i = 0; i < history_size; ++i) {
+            text += (i > 0 ? ", {\"time\": " : "{\"time\": ")
+                + std::to_string(r_distr(r_engine)) + ", \"values\": [1.5, "
+                + std::to_string(r_distr(r_engine)) + "]}";
+        }
+        text += "], \"address\": {\"city\": \"c"
+            + std::to_string(r_distr(r_engine)) + "\", \"zip\": "
+            + std::to_string(r_distr(r_engine)) + "}}\n";
+    }
+
+    return text;
+}
+
+void testLoad() {
+    assert(minijson::load(std::string()).empty());
+    assert(minijson::load(" \n\t ").empty());
+    assert(throwsInvalidArgument(" [] [] "));
+    assert(throwsInvalidArgument(" {} {} "));
+    assert(throwsInvalidArgument("[0, .]"));
+    assert(throwsInvalidArgument("[0,]"));
+    assert(throwsInvalidArgument("[0 1]"));
+    assert(throwsInvalidArgument("{\"a\" 1}"));
+    assert(throwsInvalidArgument("{[]: 1}"));
+    assert(throwsInvalidArgument("\"a\""));
+
+    const std::string json =
+        "{\"hello\": [\"world\", 1, 2.5, {}], 3: .5, \"x\": {\"y\": [[]]}}";
+    const minijson::Document document = minijson::load(json);
+    const minijson::Value root = document.at(0);
+    assert(root.isObject());
+    assert(root.size() == 3);
+    assert(root.key(1).asInteger() == 3);
+    assert(root.value(1).asReal() == 0.5);
+
+    const minijson::Value hello = root["hello"];
+    assert(hello.isList() && hello.size() == 4);
+    assert(hello[0].asString() == "world");
+    assert(hello[1].asInteger() == 1);
+    assert(hello[2].asReal() == 2.5);
+    assert(hello[3].isObject() && hello[3].size() == 0);
+    assert(root["x"]["y"][0].isList());
+}
+
+void testNumbers() {
+    const std::string json =
+        "[0, 123456789012345678, 1234567890123456789, 9223372036854775807, "
+        "1.5, .25, 3., 0.1, 123456789.123456, 1.00000000000000000000001]";
+    const minijson::Document document = minijson::load(json);
+    const minijson::Value list = document.at(0);
+    assert(list[0].asInteger() == 0);
+    assert(list[1].asInteger() == 123456789012345678L);
+    assert(list[2].asInteger() == 1234567890123456789L);
+    assert(list[3].asInteger() == 9223372036854775807L);
+    assert(list[4].asReal() == 1.5);
+    assert(list[5].asReal() == 0.25);
+    assert(list[6].asReal() == 3.0);
+    assert(list[7].asReal() == 0.1);
+    assert(list[8].asReal() == 123456789.123456);
+    assert(list[9].asReal() == 1.0);
+    assert(throwsInvalidArgument("[9223372036854775808]"));
+}
+
+void testLazy() {
+    assert(!minijson::lazyLoad(" \n\t "));
+
+    const std::string json =
+        "{\"skip\": {\"a\": [\"]}\", {}], \"b\": \"{\"}, 7: 1, "
+        "\"hello\": [\"world\", 1, 2.5, {}], \"x\": {\"y\": [[], 42]}}";
+    const minijson::LazyValue root = *minijson::lazyLoad(json);
+    assert(root.isObject());
+    assert(root.size() == 4);
+    assert(root["skip"]["b"].asString() == "{");
+    assert(root["hello"].size() == 4);
+    assert(root["hello"][0].asString() == "world");
+    assert(root["hello"][1].asInteger() == 1);
+    assert(root["hello"][2].asReal() == 2.5);
+    assert(root["hello"][3].isObject());
+    assert(root["x"]["y"][1].asInteger() == 42);
+
+    bool thrown = false;
+    try {
+        root["missing"];
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        (*minijson::lazyLoad("[1, 2"))[2];
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void testNdjson() {
+    const std::string text = "[1]\n\n{\"a\": 2}\n [3] \n[4]";
+    const std::vector<long> expected = {1, 2, 3, 4};
+
+    // Every chunk size, including chunks smaller than a line, should give the
+    // same records in the same order.
+    for (std::size_t chunk_size = 1; chunk_size <= text.size(); ++chunk_size) {
+        for (unsigned threads : {1u, 3u}) {
+            const minijson::NdjsonParser parser(threads, chunk_size);
+            std::vector<long> from_text;
+            parser.parse(std::string_view(text), [&](minijson::Value record) {
+                from_text.push_back(
+                    record.isList() ? record[0].asInteger()
+                    : record["a"].asInteger()
+                );
+            });
+            assert(from_text == expected);
+
+            std::istringstream stream(text);
+            std::vector<long> from_stream;
+            parser.parse(stream, [&](minijson::Value record) {
+                from_stream.push_back(
+                    record.isList() ? record[0].asInteger()
+                    : record["a"].asInteger()
+                );
+            });
+            assert(from_stream == expected);
+        }
+    }
+
+    // Errors report the line and come after the preceding records.
+    std::size_t count = 0;
+    try {
+        minijson::NdjsonParser(2, 4).parse(
+            std::string_view("[1]\n[2]\n[3,]\n[4]\n"),
+            [&](minijson::Value) { ++count; }
+        );
+        assert(false);
+    } catch (const std::invalid_argument & e) {
+        assert(std::string(e.what()).rfind("Line 3: ", 0) == 0);
+    }
+    assert(count == 2);
+}
+
+int main(int argc, char * argv[]) {
+    // Test correctness.
+    testLoad();
+    testNumbers();
+    testLazy();
+    testNdjson();
+
+    // Test speed of reading a few fields from each record.
+    printRow("records", "load()", "lazyLoad()");
+    for (std::size_t size : {1 << 16, 1 << 20, 1 << 24}) {
+        const std::string text = randomNdjson(size, 20);
+        std::vector<std::string_view> lines;
+        for (std::size_t front = 0; front < text.size();) {
+            const std::size_t back = text.find('\n', front);
+            lines.push_back(std::string_view(text).substr(front, back - front));
+            front = back + 1;
+        }
+
+        long load_sum = 0;
+        const double load_time = time([&]() {
+            minijson::Document document;
+            for (const auto & line : lines) {
+                document.clear();
+                const minijson::Value record =
+                    document.at(document.append(line));
+                load_sum += record["id"].asInteger()
+                    + record["address"]["zip"].asInteger();
+            }
+        });
+
+        long lazy_sum = 0;
+        const double lazy_time = time([&]() {
+            for (const auto & line : lines) {
+                const minijson::LazyValue record = *minijson::lazyLoad(line);
+                lazy_sum += record["id"].asInteger()
+                    + record["address"]["zip"].asInteger();
+            }
+        });
+        assert(load_sum == lazy_sum);
+
+        printRow(lines.size(), load_time, lazy_time);
+    }
+
+    // Test speed on a generated file. The size in MB may be given as an
+    // argument.
+    const std::size_t megabytes = argc > 1 ? std::atol(argv[1]) : 256;
+    const std::string path = "ndjson_test_input.tmp";
+    std::size_t generated_records = 0;
+    {
+        std::ofstream file(path, std::ios::binary);
+        const std::string block = randomNdjson(64 << 20);
+        const auto block_records = std::count(block.begin(), block.end(), '\n');
+        for (std::size_t written = 0; written < megabytes; written += 64) {
+            file << block;
+            generated_records += block_records;
+        }
+    }
+
+    const double load_time = time([&]() {
+        std::ifstream file(path, std::ios::binary);
+        std::string line;
+        minijson::Document document;
+        while (std::getline(file, line)) {
+            document.clear();
+            document.append(line);
+        }
+    });
+
+    printRow("threads", "load()", "NdjsonParser");
+    const unsigned max_threads =
+        std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+    for (unsigned threads : thread_counts) {
+        std::size_t records = 0;
+        const double ndjson_time = time([&]() {
+            std::ifstream file(path, std::ios::binary);
+            minijson::NdjsonParser(threads).parse(
+                file, [&](minijson::Value) { ++records; }
+            );
+        });
+        assert(records == generated_records);
+        printRow(threads, load_time, ndjson_time);
+    }
+
+    std::remove(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../merge_sort/merge_sort.hpp"
+
+
+namespace {
+
+/**
+ * Sorts a batch into a buffer.
+ *
+ * @param front An iterator to the front of the batch.
+ * @param buffer A pointer to a buffer as long as the batch.
+ * @param length The batch length.
+ */
+template<class RandAccessIterator>
+void sortIntoBuffer(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length
+) {
+    // Merge sort leaves the result in either place. Only copy it if needed.
+    if (!_mergeSort(front, buffer, length)) {
+        std::move(front, front + length, buffer);
+    }
+}
+
+/**
+ * Merges a piece of a sorted batch into its part of the list, for
+ * parallelBatchInsert().
+ *
+ * The first elements of the part were moved to a separate array, because the
+ * previous piece overwrites them. The rest were kept in place at the front of
+ * where the merged piece goes. The kept elements are merged backwards with
+ * the batch elements until one runs out, and the saved elements are merged
+ * forwards with whatever remains. Since the saved elements come before the
+ * kept ones, list elements always come before equal batch elements and keep
+ * their order, as in batchInsert().
+ *
+ * @param front An iterator to the front of the kept elements, which is also
+ * where the merged piece begins.
+ * @param kept_length The number of kept elements.
+ * @param saved A pointer to the front of the saved elements.
+ * @param saved_length The number of saved elements.
+ * @param piece A pointer to the front of the sorted batch piece.
+ * @param piece_length The batch piece length.
+ */
+template<class RandAccessIterator>
+void mergePiece(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        kept_length,
+    typename std::iterator_traits<RandAccessIterator>::value_type * saved,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        saved_length,
+    typename std::iterator_traits<RandAccessIterator>::value_type * piece,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        piece_length
+) {
+    auto back = front + (kept_length + saved_length + piece_length);
+    auto left = front + kept_length;
+    auto right = piece + piece_length;
+
+    // Merge the kept elements backwards. Equal batch elements go last.
+    while (left > front && right > piece) {
+        --back;
+        if (*(left - 1) > *(right - 1)) {
+            --left;
+            *back = std::move(*left);
+        } else {
+            --right;
+            *back = std::move(*right);
+        }
+    }
+
+    // Make room for the saved elements before any kept elements which are
+    // left, then merge the saved elements with the remaining batch elements.
+    std::move_backward(front, left, back);
+    std::merge(
+        std::make_move_iterator(saved),
+        std::make_move_iterator(saved + saved_length),
+        std::make_move_iterator(piece),
+        std::make_move_iterator(right),
+        front
+    );
+}
+
+} // namespace
+
+
+/**
+ * Inserts a batch of unsorted elements into a sorted list.
+ *
+ * The batch is sorted, moved to a buffer and merged backwards into place with
+ * the same merge which merge sort uses, so only a buffer as long as the batch
+ * is needed. The sorted list's elements which are not greater than every new
+ * element are not moved at all. This takes O(n + k log(k)) time for a list of
+ * length n and a batch of length k, instead of O((n + k) log(n + k)) for
+ * sorting everything again. Elements of the list come before equal elements
+ * of the batch.
+ *
+ * @param front A random access iterator to the front of the sorted list.
+ * @param middle A random access iterator to the back of the sorted list, which
+ * is the front of the batch.
+ * @param back A random access iterator to the back of the batch.
+ */
+template<class RandAccessIterator>
+void batchInsert(
+    RandAccessIterator front,
+    RandAccessIterator middle,
+    RandAccessIterator back
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const auto batch_length = back - middle;
+    if (batch_length == 0) {
+        return;
+    }
+
+    std::unique_ptr<value_type[]> buffer(new value_type[batch_length]);
+    sortIntoBuffer(middle, buffer.get(), batch_length);
+
+    // Elements which are not greater than the smallest new element stay.
+    const auto start = std::upper_bound(front, middle, buffer[0]);
+    if (start == middle) {
+        std::move(buffer.get(), buffer.get() + batch_length, middle);
+        return;
+    }
+
+    mergeListArray(start, buffer.get(), middle - start, back - start);
+}
+
+/**
+ * Inserts a batch of unsorted elements into a sorted list using multiple
+ * threads.
+ *
+ * The sorted batch is split into equal pieces, and the list is split where
+ * each piece begins. Each piece is then merged independently with
+ * mergePiece(). Merging a piece overwrites the front of the next piece's part
+ * of the list, so those elements are first moved to a separate array. This
+ * needs more memory than batchInsert(), up to about threads / 2 times the
+ * batch length. Like batchInsert(), it is stable.
+ *
+ * @param front A random access iterator to the front of the sorted list.
+ * @param middle A random access iterator to the back of the sorted list, which
+ * is the front of the batch.
+ * @param back A random access iterator to the back of the batch.
+ * @param threads The number of threads. Zero means one per hardware thread.
+ * @see batchInsert(RandAccessIterator, RandAccessIterator, RandAccessIterator)
+ */
+template<class RandAccessIterator>
+void parallelBatchInsert(
+    RandAccessIterator front,
+    RandAccessIterator middle,
+    RandAccessIterator back,
+    unsigned threads = 0
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+    using difference_type =
+            typename std::iterator_traits<RandAccessIterator>::difference_type;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const difference_type list_length = middle - front;
+    const difference_type batch_length = back - middle;
+    if (threads == 1 || batch_length < threads || list_length < threads) {
+        batchInsert(front, middle, back);
+        return;
+    }
+
+    std::unique_ptr<value_type[]> batch(new value_type[batch_length]);
+    sortIntoBuffer(middle, batch.get(), batch_length);
+
+    // Piece t merges batch[batch_splits[t], batch_splits[t + 1]) with
+    // list[list_splits[t], list_splits[t + 1]). List elements equal to the
+    // first element of a batch piece belong to the previous piece.
+    std::vector<difference_type> batch_splits(threads + 1);
+    std::vector<difference_type> list_splits(threads + 1);
+    for (unsigned t = 0; t <= threads; ++t) {
+        batch_splits[t] = batch_length * t / threads;
+    }
+    list_splits[0] = 0;
+    list_splits[threads] = list_length;
+    for (unsigned t = 1; t < threads; ++t) {
+        list_splits[t] =
+            std::upper_bound(front, middle, batch[batch_splits[t]]) - front;
+    }
+
+    // Piece t is written starting batch_splits[t] positions to the right of
+    // its part of the list, over the front of that part. Save the elements
+    // there to a separate array first.
+    std::vector<std::vector<value_type>> saved(threads);
+    std::vector<difference_type> kept(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const auto list_front = front + list_splits[t];
+            const auto saved_length = std::min(
+                list_splits[t + 1] - list_splits[t], batch_splits[t]
+            );
+            kept[t] = list_splits[t + 1] - list_splits[t] - saved_length;
+            saved[t].assign(
+                std::make_move_iterator(list_front),
+                std::make_move_iterator(list_front + saved_length)
+            );
+        });
+    }
+    for (auto & worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // Merge each piece into its part of the list. Elements are only kept in
+    // place if all of the front of the part was saved, so the kept elements
+    // always begin where the merged piece does.
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            mergePiece(
+                front + (list_splits[t] + batch_splits[t]),
+                kept[t],
+                saved[t].data(),
+                static_cast<difference_type>(saved[t].size()),
+                batch.get() + batch_splits[t],
+                batch_splits[t + 1] - batch_splits[t]
+            );
+        });
+    }
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
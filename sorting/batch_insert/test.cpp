@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "batch_insert.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d) {
+    constexpr int n_width = 10;
+    constexpr int rate_precision = 4;
+    constexpr int rate_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(rate_width) << std::setprecision(rate_precision) << b
+            << std::setw(rate_width) << std::setprecision(rate_precision) << c
+            << std::setw(rate_width) << std::setprecision(rate_precision) << d
+            << std::endl;
+}
+
+/**
+ * Measures sustained ingest throughput.
+ *
+ * Batches are appended to a sorted list which starts with base_length
+ * elements, and the insert function restores the order after each batch.
+ *
+ * @return The number of inserted elements per second, in millions.
+ */
+template<class Insert>
+double ingestRate(
+    long base_length, long batch_length, long batches, Insert insert
+) {
+    std::vector<int> list = randomIntList(base_length);
+    std::sort(list.begin(), list.end());
+    const std::vector<int> incoming = randomIntList(batch_length * batches);
+    list.reserve(base_length + batch_length * batches);
+
+    const double elapsed = time([&]() {
+        for (long b = 0; b < batches; ++b) {
+            const auto batch_front = incoming.begin() + b * batch_length;
+            const long old_length = list.size();
+            list.insert(list.end(), batch_front, batch_front + batch_length);
+            insert(list.begin(), list.begin() + old_length, list.end());
+        }
+    });
+    assert(isSorted(list.cbegin(), list.cend()));
+
+    return batch_length * batches / elapsed / 1e6;
+}
+
+int main() {
+    // Test correctness.
+    for (long base_length : {0, 1, 10, 1000}) {
+        for (long batch_length : {0, 1, 3, 10, 1000}) {
+            for (unsigned threads : {1u, 2u, 3u, 8u}) {
+                std::vector<int> base = randomIntList(base_length);
+                std::sort(base.begin(), base.end());
+                std::vector<int> batch = randomIntList(batch_length + 7);
+                batch.erase(batch.begin(), batch.begin() + 7);
+                for (auto & value : batch) {
+                    // Include duplicates and values beyond both ends.
+                    value = value % 3 == 0 && !base.empty()
+                        ? base[value % base.size()]
+                        : value - 1000000000;
+                }
+
+                std::vector<int> expected = base;
+                expected.insert(expected.end(), batch.begin(), batch.end());
+                std::sort(expected.begin(), expected.end());
+
+                std::vector<int> sequential = base;
+                sequential.insert(sequential.end(), batch.begin(), batch.end());
+                batchInsert(
+                    sequential.begin(),
+                    sequential.begin() + base_length,
+                    sequential.end()
+                );
+                assert(sequential == expected);
+
+                std::vector<int> parallel = base;
+                parallel.insert(parallel.end(), batch.begin(), batch.end());
+                parallelBatchInsert(
+                    parallel.begin(),
+                    parallel.begin() + base_length,
+                    parallel.end(),
+                    threads
+                );
+                assert(parallel == expected);
+            }
+        }
+    }
+
+    // Test stability. Equal list elements keep their order and come before
+    // equal batch elements, which also keep their order.
+    for (long base_length : {0, 1, 10, 1000}) {
+        for (long batch_length : {0, 1, 3, 10, 1000}) {
+            for (unsigned threads : {1u, 2u, 3u, 8u}) {
+                std::vector<Tagged> tagged;
+                for (int value : randomIntList(base_length + batch_length)) {
+                    tagged.push_back(
+                        {value % 10, static_cast<int>(tagged.size())}
+                    );
+                }
+                std::stable_sort(
+                    tagged.begin(), tagged.begin() + base_length
+                );
+
+                std::vector<Tagged> expected = tagged;
+                std::stable_sort(expected.begin(), expected.end());
+
+                std::vector<Tagged> sequential = tagged;
+                batchInsert(
+                    sequential.begin(),
+                    sequential.begin() + base_length,
+                    sequential.end()
+                );
+                assert(sequential == expected);
+
+                std::vector<Tagged> parallel = tagged;
+                parallelBatchInsert(
+                    parallel.begin(),
+                    parallel.begin() + base_length,
+                    parallel.end(),
+                    threads
+                );
+                assert(parallel == expected);
+            }
+        }
+    }
+
+    // Test ingest throughput in millions of elements per second.
+    constexpr long base_length = 10000000;
+    printRow("batch", "mergeSort()", "batchInsert()", "parallel");
+    for (long batch_length : {1000, 10000, 100000, 1000000}) {
+        const long batches = std::max(10L, 1000000 / batch_length);
+
+        const double mergeSort_rate = ingestRate(
+            base_length, batch_length, std::min(batches, 10L),
+            [](auto front, auto, auto back) {
+                mergeSort(front, back);
+            }
+        );
+
+        const double batchInsert_rate = ingestRate(
+            base_length, batch_length, batches,
+            [](auto front, auto middle, auto back) {
+                batchInsert(front, middle, back);
+            }
+        );
+
+        const double parallel_rate = ingestRate(
+            base_length, batch_length, batches,
+            [](auto front, auto middle, auto back) {
+                parallelBatchInsert(front, middle, back);
+            }
+        );
+
+        printRow(batch_length, mergeSort_rate, batchInsert_rate, parallel_rate);
+    }
+
+    return 0;
+}
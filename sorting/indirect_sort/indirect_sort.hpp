@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../merge_sort/merge_sort.hpp"
+
+
+namespace {
+
+/**
+ * A sort key paired with the index of the element it came from.
+ *
+ * Ties between keys are broken by the index, so sorting these is stable even
+ * with an unstable sort.
+ */
+template<class Key>
+struct KeyIndex {
+    Key key;
+    std::size_t index;
+
+    bool operator<(const KeyIndex & other) const {
+        return key < other.key || (!(other.key < key) && index < other.index);
+    }
+
+    bool operator>(const KeyIndex & other) const {
+        return other < *this;
+    }
+
+    bool operator<=(const KeyIndex & other) const {
+        return !(other < *this);
+    }
+};
+
+/**
+ * Maps an integer to an unsigned integer with the same order.
+ */
+template<class Integer>
+typename std::make_unsigned<Integer>::type radixBits(Integer value) {
+    using unsigned_type = typename std::make_unsigned<Integer>::type;
+
+    auto bits = static_cast<unsigned_type>(value);
+    if (std::is_signed<Integer>::value) {
+        // Flip the sign bit so negative numbers come first.
+        bits ^= unsigned_type(1) << (8 * sizeof(Integer) - 1);
+    }
+    return bits;
+}
+
+/**
+ * Performs least significant digit radix sort on key-index pairs with integer
+ * keys.
+ *
+ * Each pass distributes the pairs by one byte of the key, which is stable, so
+ * the result is sorted by key and then by index. Passes are skipped when every
+ * key has the same byte.
+ *
+ * @param pairs The pairs, which must be in index order.
+ */
+template<class Key>
+void radixSort(std::vector<KeyIndex<Key>> & pairs) {
+    constexpr int digit_bits = 8;
+    constexpr std::size_t bucket_count = 1 << digit_bits;
+    constexpr int passes = sizeof(Key);
+
+    // Count the digits for every pass at once.
+    std::vector<std::size_t> counts(passes * bucket_count, 0);
+    for (const auto & pair : pairs) {
+        const auto bits = radixBits(pair.key);
+        for (int pass = 0; pass < passes; ++pass) {
+            ++counts[
+                pass * bucket_count
+                + ((bits >> (pass * digit_bits)) & (bucket_count - 1))
+            ];
+        }
+    }
+
+    std::vector<KeyIndex<Key>> buffer(pairs.size());
+    for (int pass = 0; pass < passes; ++pass) {
+        std::size_t * pass_counts = counts.data() + pass * bucket_count;
+        const auto first_digit =
+            (radixBits(pairs[0].key) >> (pass * digit_bits))
+            & (bucket_count - 1);
+        if (pass_counts[first_digit] == pairs.size()) {
+            continue;
+        }
+
+        // Turn the counts into bucket positions.
+        std::size_t position = 0;
+        for (std::size_t digit = 0; digit < bucket_count; ++digit) {
+            const std::size_t count = pass_counts[digit];
+            pass_counts[digit] = position;
+            position += count;
+        }
+
+        for (const auto & pair : pairs) {
+            const auto digit =
+                (radixBits(pair.key) >> (pass * digit_bits))
+                & (bucket_count - 1);
+            buffer[pass_counts[digit]++] = pair;
+        }
+        pairs.swap(buffer);
+    }
+}
+
+/**
+ * Whether radix sort can be used for a key type.
+ */
+template<class Key>
+constexpr bool is_radix_key =
+    std::is_integral<Key>::value && !std::is_same<Key, bool>::value;
+
+/**
+ * Sorts key-index pairs with radix sort if the keys are integers.
+ */
+template<class Key>
+typename std::enable_if<is_radix_key<Key>>::type
+sortKeyIndexPairs(std::vector<KeyIndex<Key>> & pairs) {
+    radixSort(pairs);
+}
+
+/**
+ * Sorts key-index pairs with merge sort if the keys are not integers.
+ */
+template<class Key>
+typename std::enable_if<!is_radix_key<Key>>::type
+sortKeyIndexPairs(std::vector<KeyIndex<Key>> & pairs) {
+    mergeSort(pairs.begin(), pairs.end());
+}
+
+} // namespace
+
+
+/**
+ * Computes the permutation which sorts a list, without moving any elements.
+ *
+ * The keys are extracted once, paired with their indices and sorted. Integer
+ * keys are sorted with radix sort and other keys with merge sort. The sort is
+ * stable.
+ *
+ * The permutation can be applied to the list, or to other lists of the same
+ * length (such as the other columns of a table), with applyPermutation().
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @param key A function which returns an element's sort key.
+ * @return For each position in the sorted list, the index of the element
+ * which belongs there.
+ */
+template<class RandAccessIterator, class KeyFunction>
+std::vector<std::size_t> sortedPermutation(
+    RandAccessIterator front, RandAccessIterator back, KeyFunction key
+) {
+    using key_type = typename std::decay<decltype(key(*front))>::type;
+
+    const std::size_t length = back - front;
+    std::vector<KeyIndex<key_type>> pairs;
+    pairs.reserve(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        pairs.push_back({key(front[i]), i});
+    }
+
+    if (length > 1) {
+        sortKeyIndexPairs(pairs);
+    }
+
+    std::vector<std::size_t> permutation(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        permutation[i] = pairs[i].index;
+    }
+    return permutation;
+}
+
+/**
+ * Rearranges a list in place according to a permutation.
+ *
+ * A permutation is made of cycles. Each cycle is rotated by holding its first
+ * element aside and moving every other element directly into its final
+ * position. Every element is moved once, plus one extra move per cycle.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @param permutation For each position, the index of the element which
+ * belongs there, such as the result of sortedPermutation().
+ */
+template<class RandAccessIterator>
+void applyPermutation(
+    RandAccessIterator front,
+    RandAccessIterator back,
+    const std::vector<std::size_t> & permutation
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const std::size_t length = back - front;
+    std::vector<bool> done(length, false);
+
+    for (std::size_t start = 0; start < length; ++start) {
+        if (done[start] || permutation[start] == start) {
+            continue;
+        }
+
+        // Follow the cycle, pulling each element into the vacant position.
+        value_type tmp_value = std::move(front[start]);
+        std::size_t vacant = start;
+        while (permutation[vacant] != start) {
+            front[vacant] = std::move(front[permutation[vacant]]);
+            done[vacant] = true;
+            vacant = permutation[vacant];
+        }
+        front[vacant] = std::move(tmp_value);
+        done[vacant] = true;
+    }
+}
+
+/**
+ * Sorts a list by key, moving each element only once.
+ *
+ * This is faster than sorting the elements directly when they are large
+ * compared to their keys, because only the keys and indices are moved while
+ * sorting.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @param key A function which returns an element's sort key.
+ * @see sortedPermutation(RandAccessIterator, RandAccessIterator, KeyFunction)
+ */
+template<class RandAccessIterator, class KeyFunction>
+void indirectSort(
+    RandAccessIterator front, RandAccessIterator back, KeyFunction key
+) {
+    applyPermutation(front, back, sortedPermutation(front, back, key));
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "indirect_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 8;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::endl;
+}
+
+/**
+ * A 256-byte row with an int key.
+ */
+struct Row {
+    int key;
+    int payload[63];
+
+    bool operator<(const Row & other) const {
+        return key < other.key;
+    }
+
+    bool operator>(const Row & other) const {
+        return key > other.key;
+    }
+
+    bool operator<=(const Row & other) const {
+        return key <= other.key;
+    }
+};
+
+std::vector<Row> randomRowList(size_t size) {
+    const std::vector<int> keys = randomIntList(size);
+    std::vector<Row> rows(size);
+    for (size_t i = 0; i < size; ++i) {
+        rows[i].key = keys[i];
+        rows[i].payload[0] = i;
+    }
+    return rows;
+}
+
+int main() {
+    // Test correctness with integer keys, which use radix sort.
+    std::vector<Row> rows = randomRowList(1000);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        rows[i].key = rows[i].key % 100 - 50;
+    }
+    std::vector<int> column(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        column[i] = rows[i].payload[0];
+    }
+    const auto permutation = sortedPermutation(
+        rows.begin(), rows.end(), [](const Row & row) { return row.key; }
+    );
+    applyPermutation(rows.begin(), rows.end(), permutation);
+    assert(isSorted(rows.cbegin(), rows.cend()));
+    for (size_t i = 1; i < rows.size(); ++i) {
+        // Stable: equal keys keep their original order.
+        assert(
+            rows[i - 1].key < rows[i].key
+            || rows[i - 1].payload[0] < rows[i].payload[0]
+        );
+    }
+
+    // The permutation reorders a parallel column the same way.
+    applyPermutation(column.begin(), column.end(), permutation);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        assert(column[i] == rows[i].payload[0]);
+    }
+
+    // Test correctness with other keys, which use merge sort.
+    std::vector<std::string> strings;
+    for (int value : randomIntList(1000)) {
+        strings.push_back(std::to_string(value % 300));
+    }
+    std::vector<std::string> expected = strings;
+    std::stable_sort(expected.begin(), expected.end());
+    indirectSort(
+        strings.begin(),
+        strings.end(),
+        [](const std::string & s) { return s; }
+    );
+    assert(strings == expected);
+
+    std::vector<int> empty;
+    indirectSort(empty.begin(), empty.end(), [](int i) { return i; });
+
+    // Test speed on large records.
+    printRow("n", "mergeSort()", "indirectSort()");
+    for (long n : {100, 1000, 10000, 100000, 1000000}) {
+        std::vector<Row> unsorted = randomRowList(n);
+
+        double mergeSort_time = time([unsorted]() mutable {
+                mergeSort(unsorted.begin(), unsorted.end());
+                });
+
+        double indirectSort_time = time([unsorted]() mutable {
+                indirectSort(
+                    unsorted.begin(),
+                    unsorted.end(),
+                    [](const Row & row) { return row.key; }
+                );
+                });
+
+        printRow(n, mergeSort_time, indirectSort_time);
+    }
+
+    return 0;
+}
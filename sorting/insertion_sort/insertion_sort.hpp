@@ -6,14 +6,22 @@
 /**
  * Performs insertion sort on a list.
  *
+ * This can run at compile time, for example to sort a constexpr std::array.
+ *
  * @param front A random access iterator to the front of the list.
  * @param back A random access iterator to the back of the list.
  */
 template<class RandAccessIterator>
-void insertionSort(RandAccessIterator front, RandAccessIterator back) {
+constexpr void insertionSort(
+    RandAccessIterator front, RandAccessIterator back
+) {
     using value_type =
             typename std::iterator_traits<RandAccessIterator>::value_type;
 
+    if (back - front <= 1) {
+        return;
+    }
+
     // Build up the sorted list, one item at a time.
     for (auto unsorted = front + 1; unsorted < back; ++unsorted) {
         const value_type tmp_value = *unsorted; // The next value to insert.
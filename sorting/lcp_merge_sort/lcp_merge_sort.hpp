@@ -0,0 +1,350 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+
+namespace {
+
+/**
+ * Partitions shorter than this are sorted with multikey quicksort.
+ */
+constexpr long lcp_multikey_threshold = 32;
+
+/**
+ * Gets a character of a string for sorting.
+ *
+ * @param string The string.
+ * @param depth The position of the character.
+ * @return The character as an unsigned value plus one, or zero past the end of
+ * the string, so shorter strings come first.
+ */
+template<class String>
+int charAt(const String & string, std::size_t depth) {
+    return depth < string.size()
+        ? static_cast<unsigned char>(string[depth]) + 1
+        : 0;
+}
+
+/**
+ * Finds the length of the longest common prefix of two strings.
+ *
+ * Eight characters are compared at a time while possible.
+ *
+ * @param a The first string.
+ * @param b The second string.
+ * @param depth The length of a known common prefix.
+ * @return The length of the longest common prefix.
+ */
+template<class String>
+std::size_t commonPrefix(
+    const String & a, const String & b, std::size_t depth
+) {
+    const std::size_t length = std::min(a.size(), b.size());
+    const char * a_data = a.data();
+    const char * b_data = b.data();
+    while (depth + sizeof(std::uint64_t) <= length) {
+        std::uint64_t a_word;
+        std::uint64_t b_word;
+        std::memcpy(&a_word, a_data + depth, sizeof(a_word));
+        std::memcpy(&b_word, b_data + depth, sizeof(b_word));
+        if (a_word != b_word) {
+            break;
+        }
+        depth += sizeof(std::uint64_t);
+    }
+    while (depth < length && a_data[depth] == b_data[depth]) {
+        ++depth;
+    }
+    return depth;
+}
+
+/**
+ * Sorts strings which share a prefix with multikey quicksort, and computes
+ * their LCP values.
+ *
+ * The strings are partitioned into three parts by the character at the
+ * current depth. Only the middle part, where that character is equal, moves
+ * on to the next character. Each character of a common prefix is therefore
+ * looked at about once per string, rather than once per comparison.
+ *
+ * @param front An iterator to the front of the list.
+ * @param lcp A pointer to the LCP values. Each one is set to the length of the
+ * longest common prefix of a string and the string before it, except the
+ * first, which is left unchanged.
+ * @param length The list length.
+ * @param depth The length of a prefix which all strings share.
+ */
+template<class RandAccessIterator>
+void multikeyQuicksort(
+    RandAccessIterator front,
+    std::size_t * lcp,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length,
+    std::size_t depth
+) {
+    while (length > 1) {
+        // Use the median of three characters as the pivot.
+        int a = charAt(front[0], depth);
+        int b = charAt(front[length / 2], depth);
+        int c = charAt(front[length - 1], depth);
+        const int pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        // Partition into [front, less) < pivot, [less, greater) == pivot and
+        // [greater, front + length) > pivot.
+        auto less = front;
+        auto greater = front + length;
+        for (auto i = front; i < greater;) {
+            const int value = charAt(*i, depth);
+            if (value < pivot) {
+                std::iter_swap(less, i);
+                ++less;
+                ++i;
+            } else if (value > pivot) {
+                --greater;
+                std::iter_swap(i, greater);
+            } else {
+                ++i;
+            }
+        }
+
+        const auto less_length = less - front;
+        const auto equal_length = greater - less;
+        const auto greater_length = length - less_length - equal_length;
+
+        // Neighbours in different parts differ at this depth.
+        multikeyQuicksort(front, lcp, less_length, depth);
+        if (less_length > 0 && equal_length > 0) {
+            lcp[less_length] = depth;
+        }
+        if (greater_length > 0 && less_length + equal_length > 0) {
+            lcp[less_length + equal_length] = depth;
+        }
+        multikeyQuicksort(
+            greater, lcp + (less_length + equal_length), greater_length, depth
+        );
+
+        if (pivot == 0) {
+            // The middle part is strings which end here, which are all equal.
+            std::fill(
+                lcp + (less_length + 1), lcp + (less_length + equal_length),
+                depth
+            );
+            return;
+        }
+
+        // Continue with the middle part at the next character.
+        front = less;
+        lcp += less_length;
+        length = equal_length;
+        ++depth;
+
+        // If every string was in the middle part, they may share a long
+        // prefix. Skip all of it at once.
+        if (less_length == 0 && greater_length == 0) {
+            std::size_t shared = commonPrefix(front[0], front[1], depth);
+            for (decltype(length) i = 2; i < length && shared > depth; ++i) {
+                shared = std::min(
+                    shared, commonPrefix(front[0], front[i], depth)
+                );
+            }
+            depth = shared;
+        }
+    }
+}
+
+/**
+ * Merges two sorted lists of strings using their LCP values.
+ *
+ * Each string's LCP value is the length of its longest common prefix with the
+ * string before it in its list. The merge keeps, for the front string of each
+ * list, the LCP with the last output string. If they differ, the string with
+ * the larger LCP is smaller, with no characters compared at all. If they are
+ * equal, characters are only compared after the shared prefix. The output
+ * gets correct LCP values as well. The merge is stable.
+ *
+ * @param left An iterator to the front of the left list.
+ * @param left_lcp A pointer to the left list's LCP values.
+ * @param left_length The left list length.
+ * @param right An iterator to the front of the right list.
+ * @param right_lcp A pointer to the right list's LCP values.
+ * @param right_length The right list length.
+ * @param out An iterator to the front of the output.
+ * @param out_lcp A pointer to the output's LCP values.
+ */
+template<class InputIterator, class OutputIterator>
+void lcpMerge(
+    InputIterator left,
+    const std::size_t * left_lcp,
+    std::ptrdiff_t left_length,
+    InputIterator right,
+    const std::size_t * right_lcp,
+    std::ptrdiff_t right_length,
+    OutputIterator out,
+    std::size_t * out_lcp
+) {
+    // Both fronts are compared to the string before both lists.
+    std::size_t left_h = left_lcp[0];
+    std::size_t right_h = right_lcp[0];
+
+    while (left_length > 0 && right_length > 0) {
+        bool take_left;
+        if (left_h > right_h) {
+            take_left = true;
+        } else if (left_h < right_h) {
+            take_left = false;
+        } else {
+            const auto h = commonPrefix(*left, *right, left_h);
+            take_left = charAt(*left, h) <= charAt(*right, h);
+            // The string left behind shares the new prefix with the output.
+            if (take_left) {
+                right_h = h;
+            } else {
+                left_h = h;
+            }
+        }
+
+        if (take_left) {
+            *out = std::move(*left);
+            *out_lcp = left_h;
+            ++left;
+            ++left_lcp;
+            --left_length;
+            if (left_length > 0) {
+                left_h = *left_lcp;
+            }
+        } else {
+            *out = std::move(*right);
+            *out_lcp = right_h;
+            ++right;
+            ++right_lcp;
+            --right_length;
+            if (right_length > 0) {
+                right_h = *right_lcp;
+            }
+        }
+        ++out;
+        ++out_lcp;
+    }
+
+    // Move the rest. Its front's LCP is with the last output string.
+    if (left_length > 0) {
+        *out_lcp = left_h;
+        std::move(left, left + left_length, out);
+        std::copy(left_lcp + 1, left_lcp + left_length, out_lcp + 1);
+    } else if (right_length > 0) {
+        *out_lcp = right_h;
+        std::move(right, right + right_length, out);
+        std::copy(right_lcp + 1, right_lcp + right_length, out_lcp + 1);
+    }
+}
+
+/**
+ * Helper function for performing LCP merge sort.
+ *
+ * The halves are sorted into the opposite place from where the result should
+ * go, then merged into place, so nothing is copied back.
+ *
+ * @param front An iterator to the front of the list.
+ * @param lcp A pointer to the list's LCP values.
+ * @param buffer A pointer to the front of the buffer.
+ * @param buffer_lcp A pointer to the buffer's LCP values.
+ * @param length The list length.
+ * @param into_buffer Whether the sorted list should end up in the buffer.
+ */
+template<class RandAccessIterator>
+void _lcpMergeSort(
+    RandAccessIterator front,
+    std::size_t * lcp,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    std::size_t * buffer_lcp,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length,
+    bool into_buffer
+) {
+    if (length <= lcp_multikey_threshold) {
+        lcp[0] = 0;
+        multikeyQuicksort(front, lcp, length, 0);
+        if (into_buffer) {
+            std::move(front, front + length, buffer);
+            std::copy(lcp, lcp + length, buffer_lcp);
+        }
+        return;
+    }
+
+    const auto left_length = length / 2;
+    const auto right_length = length - left_length;
+    _lcpMergeSort(
+        front, lcp, buffer, buffer_lcp, left_length, !into_buffer
+    );
+    _lcpMergeSort(
+        front + left_length,
+        lcp + left_length,
+        buffer + left_length,
+        buffer_lcp + left_length,
+        right_length,
+        !into_buffer
+    );
+
+    if (into_buffer) {
+        lcpMerge(
+            front, lcp, left_length,
+            front + left_length, lcp + left_length, right_length,
+            buffer, buffer_lcp
+        );
+    } else {
+        lcpMerge(
+            buffer, buffer_lcp, left_length,
+            buffer + left_length, buffer_lcp + left_length, right_length,
+            front, lcp
+        );
+    }
+}
+
+} // namespace
+
+
+/**
+ * Sorts a list of strings with LCP merge sort.
+ *
+ * Every string carries the length of its longest common prefix (LCP) with the
+ * string before it. Merges use these values to decide most comparisons
+ * without looking at any characters, and otherwise compare only after the
+ * known common prefix. Partitions shorter than lcp_multikey_threshold are
+ * sorted with multikey quicksort, which computes their LCP values as it goes.
+ * This is much faster than comparison sorting when the strings have long
+ * common prefixes, such as URLs and file paths.
+ *
+ * The strings can be of any type with size(), data() and operator[] for
+ * char, such as std::string and std::string_view. They are compared by unsigned
+ * character values, like std::string's operator<. Strings with equal
+ * characters may not keep their order.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ */
+template<class RandAccessIterator>
+void lcpMergeSort(RandAccessIterator front, RandAccessIterator back) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const auto length = back - front;
+    if (length <= 1) {
+        return;
+    }
+
+    std::unique_ptr<std::size_t[]> lcp(new std::size_t[length]);
+    if (length <= lcp_multikey_threshold) {
+        multikeyQuicksort(front, lcp.get(), length, 0);
+        return;
+    }
+
+    std::unique_ptr<value_type[]> buffer(new value_type[length]);
+    std::unique_ptr<std::size_t[]> buffer_lcp(new std::size_t[length]);
+    _lcpMergeSort(
+        front, lcp.get(), buffer.get(), buffer_lcp.get(), length, false
+    );
+}
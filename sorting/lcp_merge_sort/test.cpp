@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "lcp_merge_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d) {
+    constexpr int n_width = 12;
+    constexpr int time_precision = 6;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::setw(time_width) << std::setprecision(time_precision) << d
+            << std::endl;
+}
+
+/**
+ * Creates a list of random strings.
+ *
+ * @param size The list size.
+ * @param prefixes The number of distinct shared prefixes. Each string starts
+ * with one of them.
+ * @param prefix_length The length of the shared prefixes.
+ * @param suffix_length The maximum length of the random part of each string.
+ * @param alphabet The number of distinct characters in the random part.
+ * @return The list.
+ */
+std::vector<std::string> randomStringList(
+    size_t size,
+    size_t prefixes,
+    size_t prefix_length,
+    size_t suffix_length,
+    int alphabet
+) {
+    std::default_random_engine r_engine;
+    std::uniform_int_distribution<int> r_char(0, alphabet - 1);
+    std::uniform_int_distribution<size_t> r_length(0, suffix_length);
+
+    std::vector<std::string> prefix_list;
+    for (size_t i = 0; i < prefixes; ++i) {
+        std::string prefix;
+        for (size_t j = 0; j < prefix_length; ++j) {
+            prefix += 'a' + r_char(r_engine) % 26;
+        }
+        prefix_list.push_back(prefix);
+    }
+    std::uniform_int_distribution<size_t> r_prefix(0, prefixes - 1);
+
+    std::vector<std::string> list(size);
+    for (auto & string : list) {
+        string = prefix_list[r_prefix(r_engine)];
+        const size_t length = r_length(r_engine);
+        for (size_t j = 0; j < length; ++j) {
+            string += static_cast<char>('0' + r_char(r_engine));
+        }
+    }
+    return list;
+}
+
+/**
+ * Creates a list of URLs, which share long prefixes at several levels.
+ */
+std::vector<std::string> urlList(size_t size) {
+    std::default_random_engine r_engine;
+    std::uniform_int_distribution<int> r_distr(0, 999999);
+
+    const std::vector<std::string> hosts = {
+        "https://www.example.com/",
+        "https://static.example.com/assets/",
+        "https://api.example.com/v2/",
+    };
+    const std::vector<std::string> sections = {
+        "users/profile/settings/notifications/",
+        "products/catalog/electronics/computers/laptops/",
+        "documentation/reference/sorting/algorithms/merge_sort/",
+    };
+
+    std::vector<std::string> list(size);
+    for (auto & url : list) {
+        url = hosts[r_distr(r_engine) % hosts.size()]
+            + sections[r_distr(r_engine) % sections.size()]
+            + "item?id=" + std::to_string(r_distr(r_engine) % 100000)
+            + "&page=" + std::to_string(r_distr(r_engine) % 10);
+    }
+    return list;
+}
+
+/**
+ * Lists of strings with different amounts of shared prefixes.
+ */
+std::vector<
+    std::pair<std::string, std::function<std::vector<std::string>(size_t)>>
+>
+datasets = {
+    {"random", [](size_t size) {
+        return randomStringList(size, 1, 0, 20, 75);
+    }},
+    {"prefix_10", [](size_t size) {
+        return randomStringList(size, 100, 10, 10, 10);
+    }},
+    {"prefix_100", [](size_t size) {
+        return randomStringList(size, 100, 100, 10, 10);
+    }},
+    {"prefix_1000", [](size_t size) {
+        return randomStringList(size, 10, 1000, 10, 10);
+    }},
+    {"urls", urlList},
+};
+
+int main() {
+    // Test correctness.
+    for (const auto & dataset : datasets) {
+        for (size_t n : {0, 1, 2, 3, 10, 31, 32, 33, 100, 1000, 10000}) {
+            std::vector<std::string> sort_me = dataset.second(n);
+            std::vector<std::string> expected = sort_me;
+            std::sort(expected.begin(), expected.end());
+            lcpMergeSort(sort_me.begin(), sort_me.end());
+            assert(sort_me == expected);
+        }
+    }
+
+    // Empty strings, duplicates, and prefixes of other strings.
+    std::vector<std::string> tricky;
+    for (int i = 0; i < 1000; ++i) {
+        tricky.push_back(std::string(i % 7, 'a') + std::string(i % 3, 'b'));
+        tricky.push_back("");
+        tricky.push_back(std::string(1, static_cast<char>(200 + i % 50)));
+    }
+    std::vector<std::string> expected_tricky = tricky;
+    std::sort(expected_tricky.begin(), expected_tricky.end());
+    lcpMergeSort(tricky.begin(), tricky.end());
+    assert(tricky == expected_tricky);
+
+    // Other string types.
+    const std::vector<std::string> strings = urlList(1000);
+    std::vector<std::string_view> views(strings.begin(), strings.end());
+    lcpMergeSort(views.begin(), views.end());
+    assert(std::is_sorted(views.begin(), views.end()));
+
+    // Test speed.
+    constexpr long list_length = 500000;
+    printRow("dataset", "sort()", "mergeSort()", "lcpMergeSort()");
+    for (const auto & dataset : datasets) {
+        std::vector<std::string> unsorted = dataset.second(list_length);
+
+        double sort_time = time([unsorted]() mutable {
+                std::sort(unsorted.begin(), unsorted.end());
+                });
+
+        double mergeSort_time = time([unsorted]() mutable {
+                mergeSort(unsorted.begin(), unsorted.end());
+                });
+
+        double lcpMergeSort_time = time([unsorted]() mutable {
+                lcpMergeSort(unsorted.begin(), unsorted.end());
+                });
+
+        printRow(dataset.first, sort_time, mergeSort_time, lcpMergeSort_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+
+
+namespace {
+
+/**
+ * Merges two sorted, null-terminated linked lists by relinking their nodes.
+ *
+ * Nodes are appended through a pointer to the last link, so no dummy node is
+ * needed. Once one list runs out, the rest of the other is attached with a
+ * single link. The merge is stable.
+ *
+ * @param left The first node of the first list.
+ * @param right The first node of the second list.
+ * @param next The member which links a node to the next one.
+ * @param less A function which compares two nodes.
+ * @return The first node of the merged list.
+ */
+template<class Node, class Less>
+Node * mergeLinked(
+    Node * left, Node * right, Node * Node::*next, Less & less
+) {
+    Node * head;
+    Node ** tail = &head;
+
+    while (left != nullptr && right != nullptr) {
+        if (less(*right, *left)) {
+            *tail = right;
+            tail = &(right->*next);
+            right = right->*next;
+        } else {
+            *tail = left;
+            tail = &(left->*next);
+            left = left->*next;
+        }
+    }
+    *tail = left != nullptr ? left : right;
+
+    return head;
+}
+
+} // namespace
+
+
+/**
+ * Sorts a singly linked list by relinking its nodes, with bottom-up merge
+ * sort.
+ *
+ * Nodes are taken off the front of the list one at a time. Bin i holds a
+ * sorted list of 2^i nodes, or nothing. Each new node is merged with the full
+ * bins from the bottom up, like adding one to a binary counter, and the bins
+ * are merged together at the end. Only the links are changed, so no values are
+ * moved and nothing is allocated. The bins live on the stack. The sort is
+ * stable.
+ *
+ * @param head The first node of a null-terminated list.
+ * @param next The member which links a node to the next one, such as
+ * &Node::next.
+ * @param less A function which compares two nodes. Defaults to operator<.
+ * @return The first node of the sorted list.
+ */
+template<class Node, class Less = std::less<Node>>
+Node * linkedMergeSort(Node * head, Node * Node::*next, Less less = Less()) {
+    // Enough bins for any list which fits in memory.
+    constexpr int bin_count = 64;
+    Node * bins[bin_count] = {};
+    int used_bins = 0;
+
+    while (head != nullptr) {
+        Node * carry = head;
+        head = head->*next;
+        carry->*next = nullptr;
+
+        // Merge with full bins until an empty one is found. Bins hold earlier
+        // nodes than the carry, so they go on the left.
+        int bin = 0;
+        for (; bin < used_bins && bins[bin] != nullptr; ++bin) {
+            carry = mergeLinked(bins[bin], carry, next, less);
+            bins[bin] = nullptr;
+        }
+        bins[bin] = carry;
+        if (bin == used_bins) {
+            ++used_bins;
+        }
+    }
+
+    // Higher bins hold earlier nodes.
+    Node * sorted = nullptr;
+    for (int bin = 0; bin < used_bins; ++bin) {
+        if (bins[bin] != nullptr) {
+            sorted = sorted == nullptr
+                ? bins[bin]
+                : mergeLinked(bins[bin], sorted, next, less);
+        }
+    }
+
+    return sorted;
+}
+
+/**
+ * Sorts a doubly linked list by relinking its nodes.
+ *
+ * The list is sorted through its forward links only, and the backward links
+ * are restored in a final pass.
+ *
+ * @param head The first node of a null-terminated list.
+ * @param next The member which links a node to the next one.
+ * @param prev The member which links a node to the previous one.
+ * @param less A function which compares two nodes. Defaults to operator<.
+ * @return The first and last nodes of the sorted list.
+ * @see linkedMergeSort(Node *, Node * Node::*, Less)
+ */
+template<class Node, class Less = std::less<Node>>
+std::pair<Node *, Node *> linkedMergeSort(
+    Node * head, Node * Node::*next, Node * Node::*prev, Less less = Less()
+) {
+    head = linkedMergeSort(head, next, less);
+
+    Node * previous = nullptr;
+    for (Node * node = head; node != nullptr; node = node->*next) {
+        node->*prev = previous;
+        previous = node;
+    }
+
+    return {head, previous};
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "linked_merge_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d, T2 e) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 6;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::setw(time_width) << std::setprecision(time_precision) << d
+            << std::setw(time_width) << std::setprecision(time_precision) << e
+            << std::endl;
+}
+
+/**
+ * A node of an intrusive doubly linked list.
+ */
+struct Node {
+    int value;
+    int tag;
+    Node * next;
+    Node * prev;
+
+    bool operator<(const Node & other) const {
+        return value < other.value;
+    }
+};
+
+/**
+ * Links nodes in order into a null-terminated doubly linked list.
+ *
+ * @return The first node.
+ */
+Node * linkNodes(std::vector<Node> & nodes) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].next = i + 1 < nodes.size() ? &nodes[i + 1] : nullptr;
+        nodes[i].prev = i > 0 ? &nodes[i - 1] : nullptr;
+    }
+    return nodes.empty() ? nullptr : &nodes[0];
+}
+
+/**
+ * Creates nodes with random values.
+ */
+std::vector<Node> randomNodes(size_t size, int modulus) {
+    std::vector<Node> nodes;
+    for (int value : randomIntList(size)) {
+        nodes.push_back(
+            {value % modulus, static_cast<int>(nodes.size()), nullptr, nullptr}
+        );
+    }
+    return nodes;
+}
+
+int main() {
+    // Test correctness.
+    for (size_t n : {0, 1, 2, 3, 7, 8, 100, 1000, 12345}) {
+        for (int modulus : {10, 1 << 30}) {
+            std::vector<Node> nodes = randomNodes(n, modulus);
+            std::vector<int> expected;
+            for (const auto & node : nodes) {
+                expected.push_back(node.value);
+            }
+            std::sort(expected.begin(), expected.end());
+
+            // Singly linked, and stable.
+            Node * head = linkedMergeSort(linkNodes(nodes), &Node::next);
+            std::vector<int> sorted;
+            for (Node * node = head; node != nullptr; node = node->next) {
+                sorted.push_back(node->value);
+                assert(
+                    node->next == nullptr
+                    || node->value < node->next->value
+                    || node->tag < node->next->tag
+                );
+            }
+            assert(sorted == expected);
+
+            // Doubly linked, in descending order with a custom comparison.
+            const auto sorted_ends = linkedMergeSort(
+                linkNodes(nodes),
+                &Node::next,
+                &Node::prev,
+                [](const Node & a, const Node & b) {
+                    return a.value > b.value;
+                }
+            );
+            std::vector<int> backward;
+            for (Node * node = sorted_ends.second; node; node = node->prev) {
+                backward.push_back(node->value);
+            }
+            assert(backward == expected);
+            assert(n == 0 || sorted_ends.first->prev == nullptr);
+        }
+    }
+
+    // Test speed.
+    printRow("n", "list::sort()", "mergeSort()", "singly", "doubly");
+    for (long n : {1000, 10000, 100000, 1000000, 10000000}) {
+        const std::vector<int> values = randomIntList(n);
+        const int repeats = std::max(1L, 1000000 / n);
+
+        std::list<int> list(values.begin(), values.end());
+        double list_sort_time = time([&]() {
+            for (int i = 0; i < repeats; ++i) {
+                std::list<int> copy = list;
+                copy.sort();
+            }
+        });
+        list_sort_time -= time([&]() {
+            for (int i = 0; i < repeats; ++i) {
+                std::list<int> copy = list;
+            }
+        });
+
+        double mergeSort_time = time([&]() {
+            for (int i = 0; i < repeats; ++i) {
+                std::list<int> copy = list;
+                std::vector<int> vector(copy.begin(), copy.end());
+                mergeSort(vector.begin(), vector.end());
+                std::copy(vector.begin(), vector.end(), copy.begin());
+            }
+        });
+        mergeSort_time -= time([&]() {
+            for (int i = 0; i < repeats; ++i) {
+                std::list<int> copy = list;
+            }
+        });
+
+        std::vector<Node> nodes = randomNodes(0, 1);
+        for (int value : values) {
+            nodes.push_back({value, 0, nullptr, nullptr});
+        }
+        double singly_time = 0;
+        double doubly_time = 0;
+        for (int i = 0; i < repeats; ++i) {
+            Node * head = linkNodes(nodes);
+            singly_time += time([&]() {
+                linkedMergeSort(head, &Node::next);
+            });
+            head = linkNodes(nodes);
+            doubly_time += time([&]() {
+                linkedMergeSort(head, &Node::next, &Node::prev);
+            });
+        }
+
+        printRow(
+            n,
+            list_sort_time / repeats,
+            mergeSort_time / repeats,
+            singly_time / repeats,
+            doubly_time / repeats
+        );
+    }
+
+    return 0;
+}
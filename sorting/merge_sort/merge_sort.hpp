@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "../insertion_sort/insertion_sort.hpp"
 
@@ -69,7 +72,7 @@ void merge(int * array, const unsigned long split, const unsigned long length) {
  * @see merge(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type, typename std::iterator_traits<RandAccessIterator>::difference_type, bool, bool)
  */
 template<class RandAccessIterator>
-void mergeBufferBuffer(
+constexpr void mergeBufferBuffer(
     RandAccessIterator front,
     typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
     typename std::iterator_traits<RandAccessIterator>::difference_type middle,
@@ -82,7 +85,7 @@ void mergeBufferBuffer(
 
     // Merge the lists until one list is completely processed.
     while (true) {
-        if (*left < *right) {
+        if (*left <= *right) {
             *front = *left;
             ++front;
             ++left;
@@ -121,7 +124,7 @@ void mergeBufferBuffer(
  * @see merge(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type, typename std::iterator_traits<RandAccessIterator>::difference_type, bool, bool)
  */
 template<class RandAccessIterator>
-void mergeBufferList(
+constexpr void mergeBufferList(
     RandAccessIterator front,
     typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
     typename std::iterator_traits<RandAccessIterator>::difference_type middle,
@@ -134,7 +137,7 @@ void mergeBufferList(
 
     // Merge the lists until one list is completely processed.
     while (true) {
-        if (*left < *right) {
+        if (*left <= *right) {
             *front = *left;
             ++front;
             ++left;
@@ -167,67 +170,84 @@ void mergeBufferList(
 }
 
 /**
- * Merge two lists, the first in the origin and the second in the buffer, to the
- * origin.
+ * Merge two lists, the first in the origin and the second in a separate array,
+ * to the origin.
  *
- * @see merge(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type, typename std::iterator_traits<RandAccessIterator>::difference_type, bool, bool)
+ * The origin must have room for both lists.
+ *
+ * @param front An iterator at the front of the origin.
+ * @param right_list A pointer to the front of the second list.
+ * @param middle The length of the first list.
+ * @param length The total length of the two lists.
  */
 template<class RandAccessIterator>
-void mergeListBuffer(
+constexpr void mergeListArray(
     RandAccessIterator front,
-    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::value_type * right_list,
     typename std::iterator_traits<RandAccessIterator>::difference_type middle,
     typename std::iterator_traits<RandAccessIterator>::difference_type length
 ) {
-    // This function works backwards to avoid overwriting the origin.
+    // This function works backwards to avoid overwriting the origin. Each
+    // iterator points one past the next element to take, so none of them ever
+    // moves before the front of its list.
 
-    auto list_back = front + length - 1;
-    auto left = front + middle - 1;
+    auto list_back = front + length;
+    auto left = front + middle;
     auto left_end = front;
-    auto right = buffer + length - 1;
-    auto right_end = buffer + middle;
+    auto right = right_list + (length - middle);
+    auto right_end = right_list;
 
     // Merge the lists until one list is completely processed.
     while (true) {
-        if (*left > *right) {
-            *list_back = *left;
+        if (*(left - 1) > *(right - 1)) {
             --list_back;
             --left;
-            if (left < left_end) {
+            *list_back = *left;
+            if (left == left_end) {
                 break;
             }
         } else {
-            *list_back = *right;
             --list_back;
             --right;
-            if (right < right_end) {
+            *list_back = *right;
+            if (right == right_end) {
                 break;
             }
         }
     }
 
-    // Dump the remainder of the first list into the merged list.
-    while (left >= left_end) {
-        *list_back = *left;
-        --list_back;
-        --left;
-    }
-
-    // Dump the remainder of the second list into the merged list.
-    while (right >= right_end) {
-        *list_back = *right;
+    // The remainder of the first list is already in place. Dump the remainder
+    // of the second list into the merged list.
+    while (right > right_end) {
         --list_back;
         --right;
+        *list_back = *right;
     }
 }
 
+/**
+ * Merge two lists, the first in the origin and the second in the buffer, to the
+ * origin.
+ *
+ * @see merge(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type, typename std::iterator_traits<RandAccessIterator>::difference_type, bool, bool)
+ */
+template<class RandAccessIterator>
+constexpr void mergeListBuffer(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::difference_type middle,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length
+) {
+    mergeListArray(front, buffer + middle, middle, length);
+}
+
 /**
  * Merge two lists from the origin to the buffer.
  *
  * @see merge(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type, typename std::iterator_traits<RandAccessIterator>::difference_type, bool, bool)
  */
 template<class RandAccessIterator>
-void mergeListList(
+constexpr void mergeListList(
     RandAccessIterator front,
     typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
     typename std::iterator_traits<RandAccessIterator>::difference_type middle,
@@ -240,7 +260,7 @@ void mergeListList(
 
     // Merge the lists until one list is completely processed.
     while (true) {
-        if (*left < *right) {
+        if (*left <= *right) {
             *buffer = *left;
             ++buffer;
             ++left;
@@ -289,7 +309,7 @@ void mergeListList(
  * @return Whether the merged list is in the buffer.
  */
 template<class RandAccessIterator>
-bool merge(
+constexpr bool merge(
     RandAccessIterator front,
     typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
     typename std::iterator_traits<RandAccessIterator>::difference_type middle,
@@ -314,38 +334,288 @@ bool merge(
     return false;
 }
 
+/**
+ * The longest parts which merge sort hands to insertion sort by default.
+ */
+constexpr long merge_insertion_limit = 5;
+
 /**
  * Helper function for performing merge sort.
  *
  * @param front An iterator to the front of the list.
  * @param buffer A pointer to the front of the buffer.
  * @param length The list length.
+ * @param insertion_limit Parts up to this long are insertion sorted.
  * @return Whether the sorted list is in the buffer.
  */
 template<class RandAccessIterator>
-bool _mergeSort(
+constexpr bool _mergeSort(
     RandAccessIterator front,
     typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
-    typename std::iterator_traits<RandAccessIterator>::difference_type length
+    typename std::iterator_traits<RandAccessIterator>::difference_type length,
+    long insertion_limit = merge_insertion_limit
 ) {
     // Use a simpler sorting algorithm for the last part to improve speed.
-    if (length <= 5) {
+    if (length < 2 || length <= insertion_limit) {
         insertionSort(front, front + length);
         return false;
     }
 
     const auto left_length = length / 2;
-    const bool left_in_buffer = _mergeSort(front, buffer, left_length);
+    const bool left_in_buffer =
+        _mergeSort(front, buffer, left_length, insertion_limit);
     const bool right_in_buffer = _mergeSort(
-        front + left_length, buffer + left_length, length - left_length
+        front + left_length,
+        buffer + left_length,
+        length - left_length,
+        insertion_limit
     );
-    const bool in_buffer = merge(
+    // The parentheses stop argument-dependent lookup, which would find
+    // std::merge() when the list holds standard types through raw pointers.
+    const bool in_buffer = (merge)(
         front, buffer, left_length, length, left_in_buffer, right_in_buffer
     );
 
     return in_buffer;
 }
 
+/**
+ * Merge a run of pending elements with the block which follows it, using a
+ * buffer which can hold the pending elements. Helper for mergeBlocks().
+ *
+ * The merge stops as soon as either side runs out. Whatever is left of the
+ * other side becomes the new pending run, at the back of the block.
+ *
+ * @param pending An iterator at the front of the pending elements.
+ * @param block An iterator at the front of the block, which is also the back
+ * of the pending elements.
+ * @param block_back An iterator at the back of the block.
+ * @param buffer A pointer to the front of the buffer.
+ * @param pending_first Whether the pending elements come from the first list,
+ * so that they go before equal elements of the block.
+ * @return An iterator at the front of the new pending elements, and whether
+ * they are still the old pending elements.
+ */
+template<class RandAccessIterator>
+std::pair<RandAccessIterator, bool> mergePending(
+    RandAccessIterator pending,
+    RandAccessIterator block,
+    RandAccessIterator block_back,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    bool pending_first
+) {
+    auto left = buffer;
+    const auto left_end = std::move(pending, block, buffer);
+    auto right = block;
+    auto merged = pending;
+
+    while (left < left_end && right < block_back) {
+        if (pending_first ? *left <= *right : *left < *right) {
+            *merged = std::move(*left);
+            ++left;
+        } else {
+            *merged = std::move(*right);
+            ++right;
+        }
+        ++merged;
+    }
+
+    // Either the rest of the block is already in place, or the rest of the
+    // pending elements go at the back of the block.
+    if (left == left_end) {
+        return std::make_pair(right, false);
+    }
+    std::move(left, left_end, merged);
+    return std::make_pair(merged, true);
+}
+
+/**
+ * Merge two adjacent sorted lists in the origin by moving whole blocks, using
+ * a buffer which holds one block.
+ *
+ * The front of the first list, shorter than a block, is left where it is. The
+ * back of the second list, also shorter than a block, is merged in last. All
+ * other elements are cut into blocks. A selection pass puts the blocks in
+ * order of their first elements. Blocks of the first list go before blocks of
+ * the second list with equal first elements, and each list's blocks keep their
+ * order, which is tracked with one index per block. After this, every element is less than one block
+ * away from its place. Neighbouring blocks from different lists are then
+ * merged locally with mergePending(), and whatever is left of one block is
+ * carried into the merge with the next one. The merge is stable.
+ *
+ * With m elements and blocks of length s, the selection pass makes O((m / s)^2)
+ * comparisons and O(m) moves, and the local merges take O(m) time. So the
+ * merge takes O(m) time when s is at least sqrt(m).
+ *
+ * @param front An iterator at the front of the first list.
+ * @param middle The length of the first list.
+ * @param length The total length of the two lists.
+ * @param buffer A pointer to the front of the buffer.
+ * @param block_length The block length, at most the buffer length.
+ */
+template<class RandAccessIterator>
+void mergeBlocks(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::difference_type middle,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        block_length
+) {
+    using difference_type =
+            typename std::iterator_traits<RandAccessIterator>::difference_type;
+
+    const difference_type left_blocks = middle / block_length;
+    const difference_type block_count =
+        left_blocks + (length - middle) / block_length;
+    const auto blocks = front + middle % block_length;
+    const auto block = [&](difference_type index) {
+        return blocks + index * block_length;
+    };
+
+    // Tags below left_blocks belong to blocks of the first list, in order.
+    std::vector<difference_type> tags(block_count);
+    for (difference_type i = 0; i < block_count; ++i) {
+        tags[i] = i;
+    }
+
+    // The remaining blocks of the first list are somewhere in
+    // [i, i + left_remaining). The remaining blocks of the second list follow
+    // them, in order. Choose the block which goes at i.
+    difference_type left_remaining = left_blocks;
+    for (difference_type i = 0; i < block_count && left_remaining > 0; ++i) {
+        difference_type chosen = i;
+        for (difference_type j = i + 1; j < i + left_remaining; ++j) {
+            if (tags[j] < tags[chosen]) {
+                chosen = j;
+            }
+        }
+        const difference_type next_right = i + left_remaining;
+        if (next_right < block_count && *block(next_right) < *block(chosen)) {
+            chosen = next_right;
+        } else {
+            --left_remaining;
+        }
+
+        if (chosen != i) {
+            std::swap_ranges(block(i), block(i + 1), block(chosen));
+            std::swap(tags[i], tags[chosen]);
+        }
+    }
+
+    // Merge neighbouring blocks from different lists. The front of the first
+    // list is the first run of pending elements.
+    auto pending = front;
+    bool pending_first = true;
+    for (difference_type i = 0; i < block_count; ++i) {
+        const bool block_first = tags[i] < left_blocks;
+        if (pending == block(i) || block_first == pending_first) {
+            pending = block(i);
+            pending_first = block_first;
+            continue;
+        }
+
+        const auto merged = mergePending(
+            pending, block(i), block(i + 1), buffer, pending_first
+        );
+        pending = merged.first;
+        pending_first = merged.second ? pending_first : block_first;
+    }
+
+    // The back of the second list is shorter than a block, but may belong
+    // anywhere. Merge it backwards into everything else.
+    const difference_type sorted_length = block(block_count) - front;
+    if (sorted_length < length) {
+        std::move(block(block_count), front + length, buffer);
+        mergeListArray(front, buffer, sorted_length, length);
+    }
+}
+
+/**
+ * Merge two adjacent sorted lists in the origin using a buffer which may be
+ * too small to hold either list.
+ *
+ * If the shorter list fits in the buffer, it is moved there and merged back
+ * with mergeBufferList() or mergeListArray(). If the buffer holds at least
+ * sqrt(length) elements, the lists are merged in blocks as long as the buffer
+ * with mergeBlocks(). Both take O(length) time. Otherwise, the longer list is
+ * split in half and the matching split point of the other list is found with
+ * binary search. Rotating the middle pieces leaves two smaller merge problems,
+ * each of which is solved the same way, until they are short enough for
+ * mergeBlocks(). The merge is stable.
+ *
+ * @param front An iterator at the front of the first list.
+ * @param middle The length of the first list.
+ * @param length The total length of the two lists.
+ * @param buffer A pointer to the front of the buffer.
+ * @param buffer_length The buffer length.
+ */
+template<class RandAccessIterator>
+void mergeBounded(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::difference_type middle,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        buffer_length
+) {
+    const auto left_length = middle;
+    const auto right_length = length - middle;
+    if (left_length == 0 || right_length == 0) {
+        return;
+    }
+
+    // Nothing to do if the lists are already in order.
+    if (front[middle - 1] <= front[middle]) {
+        return;
+    }
+    if (length == 2) {
+        std::iter_swap(front, front + 1);
+        return;
+    }
+
+    if (left_length <= right_length && left_length <= buffer_length) {
+        std::move(front, front + middle, buffer);
+        mergeBufferList(front, buffer, middle, length);
+        return;
+    }
+    if (right_length <= buffer_length) {
+        std::move(front + middle, front + length, buffer);
+        mergeListArray(front, buffer, middle, length);
+        return;
+    }
+    if (buffer_length * buffer_length >= length) {
+        mergeBlocks(front, middle, length, buffer, buffer_length);
+        return;
+    }
+
+    // Split the longer list in half and find where its middle element would
+    // go in the other list. Elements equal to it stay on the left side to keep
+    // the merge stable.
+    RandAccessIterator left_cut, right_cut;
+    if (left_length > right_length) {
+        left_cut = front + left_length / 2;
+        right_cut = std::lower_bound(front + middle, front + length, *left_cut);
+    } else {
+        right_cut = front + middle + right_length / 2;
+        left_cut = std::upper_bound(front, front + middle, *right_cut);
+    }
+
+    // Swap the right part of the first list with the left part of the second.
+    const auto new_middle = std::rotate(left_cut, front + middle, right_cut);
+
+    mergeBounded(
+        front, left_cut - front, new_middle - front, buffer, buffer_length
+    );
+    mergeBounded(
+        new_middle,
+        right_cut - new_middle,
+        (front + length) - new_middle,
+        buffer,
+        buffer_length
+    );
+}
+
 } // namespace
 
 /**
@@ -367,6 +637,36 @@ void mergeSort(int * array, const unsigned long length) {
     merge(array, middle, length);
 }
 
+/**
+ * Perform merge sort on a list using a buffer supplied by the caller.
+ *
+ * Nothing is allocated, so this can run at compile time, for example to sort
+ * a constexpr std::array with a plain array as the buffer.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @param buffer A pointer to the front of a buffer at least as long as the
+ * list.
+ * @param insertion_limit Parts up to this long are insertion sorted.
+ */
+template<class RandAccessIterator>
+constexpr void bufferedMergeSort(
+    RandAccessIterator front,
+    RandAccessIterator back,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    long insertion_limit = merge_insertion_limit
+) {
+    const auto length = back - front;
+    const bool in_buffer = _mergeSort(front, buffer, length, insertion_limit);
+
+    // Copy results from the buffer if it is there instead of the origin.
+    if (in_buffer) {
+        for (decltype(back - front) i = 0; i < length; ++i) {
+            front[i] = buffer[i];
+        }
+    }
+}
+
 /**
  * Perform merge sort on a list.
  *
@@ -378,17 +678,82 @@ void mergeSort(RandAccessIterator front, RandAccessIterator back) {
     using value_type =
             typename std::iterator_traits<RandAccessIterator>::value_type;
 
-    auto length = back - front;
     auto buffer = new value_type[back - front];
+    bufferedMergeSort(front, back, buffer);
+    delete[] buffer;
+}
+
+/**
+ * Perform merge sort on a list using a buffer of limited size.
+ *
+ * Runs as long as the buffer are sorted with the usual buffered merge sort.
+ * The runs are then merged pairwise with mergeBounded(), which uses the buffer
+ * when a list fits, block merges when the buffer is at least the square root
+ * of the merge length, and rotations otherwise. The sort is stable. With no
+ * buffer at all, no memory is allocated.
+ *
+ * With a buffer of length b of at least sqrt(n), every merge takes linear
+ * time, so the sort takes O(n log(n)) time. The block merges also allocate one
+ * index per block, at most sqrt(n) of them. Smaller buffers need rotations,
+ * and with no buffer the sort takes O(n log(n)^2) time.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @param max_buffer_length The maximum number of elements to allocate for the
+ * buffer.
+ */
+template<class RandAccessIterator>
+void mergeSort(
+    RandAccessIterator front,
+    RandAccessIterator back,
+    typename std::iterator_traits<RandAccessIterator>::difference_type
+        max_buffer_length
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+    using difference_type =
+            typename std::iterator_traits<RandAccessIterator>::difference_type;
 
-    const bool in_buffer = _mergeSort(front, buffer, back - front);
+    const difference_type length = back - front;
+    if (max_buffer_length >= length) {
+        mergeSort(front, back);
+        return;
+    }
 
-    // Copy results from the buffer if it is there instead of the origin.
-    if (in_buffer) {
-        for (int i = 0; i < length; ++i) {
-            front[i] = buffer[i];
+    const difference_type buffer_length =
+        std::max(max_buffer_length, static_cast<difference_type>(0));
+    std::unique_ptr<value_type[]> buffer(
+        buffer_length > 0 ? new value_type[buffer_length] : nullptr
+    );
+
+    // Sort runs which fit in the buffer. Runs of 5 or fewer are sorted with
+    // insertion sort and do not need the buffer.
+    const difference_type run_length =
+        std::max(buffer_length, static_cast<difference_type>(5));
+    for (difference_type run = 0; run < length; run += run_length) {
+        const auto run_end = std::min(run + run_length, length);
+        const bool in_buffer =
+            _mergeSort(front + run, buffer.get(), run_end - run);
+        if (in_buffer) {
+            std::move(buffer.get(), buffer.get() + (run_end - run), front + run);
         }
     }
 
-    delete[] buffer;
+    // Merge the runs bottom-up.
+    for (difference_type width = run_length; width < length; width *= 2) {
+        for (
+            difference_type left = 0;
+            left + width < length;
+            left += 2 * width
+        ) {
+            const auto merge_length = std::min(2 * width, length - left);
+            mergeBounded(
+                front + left,
+                width,
+                merge_length,
+                buffer.get(),
+                buffer_length
+            );
+        }
+    }
 }
@@ -1,8 +1,13 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "../../test_utils.hpp"
@@ -24,6 +29,45 @@ void printRow(T1 a, T2 b, T2 c) {
             << std::endl;
 }
 
+/**
+ * Checks that equal values kept their original order, given by their tags.
+ */
+bool isStable(const std::vector<Tagged> & list) {
+    for (size_t i = 1; i < list.size(); ++i) {
+        if (
+            list[i - 1].value == list[i].value
+            && list[i - 1].tag > list[i].tag
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Tagged> randomTaggedList(size_t size) {
+    const std::vector<int> values = randomIntList(size);
+    std::vector<Tagged> list(size);
+    for (size_t i = 0; i < size; ++i) {
+        list[i] = {values[i] % 100, static_cast<int>(i)};
+    }
+    return list;
+}
+
+/**
+ * Sorts a table with bufferedMergeSort(), using a plain array as the buffer.
+ */
+template<class T, std::size_t size>
+constexpr std::array<T, size> mergeSorted(std::array<T, size> table) {
+    T buffer[size] = {};
+    bufferedMergeSort(table.begin(), table.end(), buffer);
+    return table;
+}
+
+constexpr std::array<std::string_view, 12> keywords = {
+    "while", "auto", "if", "return", "do", "for",
+    "break", "else", "switch", "case", "continue", "const",
+};
+
 int main() {
     std::vector<int> sort_me = randomIntList(1000);
 
@@ -32,6 +76,56 @@ int main() {
     mergeSort(sort_me.begin(), sort_me.end());
     assert(isSorted(sort_me.cbegin(), sort_me.cend()));
 
+    std::vector<Tagged> stable_me = randomTaggedList(10000);
+    mergeSort(stable_me.begin(), stable_me.end());
+    assert(isSorted(stable_me.cbegin(), stable_me.cend()));
+    assert(isStable(stable_me));
+
+    for (long insertion_limit : {0L, 1L, 2L, 64L}) {
+        std::vector<Tagged> limited = randomTaggedList(1000);
+        std::vector<Tagged> buffer(limited.size());
+        bufferedMergeSort(
+            limited.begin(), limited.end(), buffer.data(), insertion_limit
+        );
+        assert(isSorted(limited.cbegin(), limited.cend()));
+        assert(isStable(limited));
+    }
+
+    // Test sorting at compile time, and that the result matches sorting the
+    // same table at run time.
+    constexpr auto int_table = constexprIntTable<300>();
+    constexpr auto sorted_int_table = mergeSorted(int_table);
+    static_assert(isSorted(sorted_int_table.begin(), sorted_int_table.end()));
+    assert(mergeSorted(int_table) == sorted_int_table);
+    std::vector<int> runtime_table(int_table.begin(), int_table.end());
+    mergeSort(runtime_table.begin(), runtime_table.end());
+    assert(std::equal(
+        runtime_table.begin(), runtime_table.end(), sorted_int_table.begin()
+    ));
+
+    constexpr auto sorted_keywords = mergeSorted(keywords);
+    static_assert(sorted_keywords.front() == "auto");
+    static_assert(sorted_keywords.back() == "while");
+    static_assert(isSorted(sorted_keywords.begin(), sorted_keywords.end()));
+    assert(mergeSorted(keywords) == sorted_keywords);
+
+    static_assert(mergeSorted(std::array<int, 1>{7})[0] == 7);
+    static_assert(mergeSorted(std::array<int, 2>{7, 3})[0] == 3);
+
+    // Test correctness with a limited buffer. Buffers of about sqrt(n) use
+    // block merges.
+    for (long n : {0, 1, 2, 7, 100, 1000, 10007, 100003}) {
+        const long root = static_cast<long>(std::sqrt(n));
+        for (long buffer_length : {
+            0L, 1L, 5L, 6L, 31L, root - 1, root, root + 1, n / 8, n / 2, n
+        }) {
+            std::vector<Tagged> unsorted = randomTaggedList(n);
+            mergeSort(unsorted.begin(), unsorted.end(), buffer_length);
+            assert(isSorted(unsorted.cbegin(), unsorted.cend()));
+            assert(isStable(unsorted));
+        }
+    }
+
     // Test speed.
     printRow("n", "sort()", "mergeSort()");
     for (long n : {100, 1000, 10000, 100000, 1000000, 10000000, 100000000}) {
@@ -48,5 +142,29 @@ int main() {
         printRow(n, sort_time, mergeSort_time);
     }
 
+    // Test the time and memory trade-off of a limited buffer.
+    constexpr long n = 10000000;
+    const std::vector<std::pair<std::string, long>> buffer_lengths = {
+        {"n", n},
+        {"n/2", n / 2},
+        {"n/8", n / 8},
+        {"sqrt(n)", static_cast<long>(std::sqrt(n))},
+        {"0", 0},
+    };
+    printRow("buffer", "time", "memory (MB)");
+    for (const auto & buffer_length : buffer_lengths) {
+        std::vector<int> unsorted = randomIntList(n);
+
+        double mergeSort_time = time([&unsorted, &buffer_length]() {
+                mergeSort(unsorted.begin(), unsorted.end(), buffer_length.second);
+                });
+
+        printRow(
+            buffer_length.first,
+            mergeSort_time,
+            buffer_length.second * sizeof(int) / 1e6
+        );
+    }
+
     return 0;
 }
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "../insertion_sort/insertion_sort.hpp"
+#include "../pdq_sort/pdq_sort.hpp"
+
+
+namespace {
+
+/**
+ * Chooses a pivot and moves it to the front of a list, as in pdqSort().
+ *
+ * The element at the back minus one is then not less than the pivot.
+ *
+ * @param front An iterator to the front of the list.
+ * @param back An iterator to the back of the list.
+ */
+template<class RandAccessIterator>
+void choosePivot(RandAccessIterator front, RandAccessIterator back) {
+    const auto length = back - front;
+    const auto half = length / 2;
+    if (length > pdq_ninther_threshold) {
+        sortThree(front, front + half, back - 1);
+        sortThree(front + 1, front + (half - 1), back - 2);
+        sortThree(front + 2, front + (half + 1), back - 3);
+        sortThree(front + (half - 1), front + half, front + (half + 1));
+        std::iter_swap(front, front + half);
+    } else {
+        sortThree(front + half, front, back - 1);
+    }
+}
+
+/**
+ * Partitions a list around the pivot at its front, as in pdqSort().
+ *
+ * Arithmetic types use the branchless block partition.
+ *
+ * @param front An iterator to the front of the list.
+ * @param back An iterator to the back of the list.
+ * @return An iterator to the pivot's final position.
+ */
+template<class RandAccessIterator>
+RandAccessIterator partitionPivot(
+    RandAccessIterator front, RandAccessIterator back
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    if (std::is_arithmetic<value_type>::value) {
+        return partitionRightBranchless(front, back).first;
+    }
+    return partitionRight(front, back).first;
+}
+
+/**
+ * @return About log2(length), the number of bad partitions allowed before
+ * giving up on quickselect.
+ */
+template<class Integer>
+int badPartitionsAllowed(Integer length) {
+    int bad_allowed = 0;
+    for (; length > 0; length /= 2) {
+        ++bad_allowed;
+    }
+    return bad_allowed;
+}
+
+/**
+ * Rearranges a list so that the element at nth is the one which would be
+ * there if the list were sorted, with no greater elements before it and no
+ * smaller elements after it.
+ *
+ * This is quickselect using the pivots and partitions of pdqSort(). It takes
+ * O(n) time on average. Too many bad partitions make it sort the remaining
+ * part with pdqSort() instead.
+ *
+ * @param front An iterator to the front of the list.
+ * @param nth An iterator to the position to fill.
+ * @param back An iterator to the back of the list.
+ */
+template<class RandAccessIterator>
+void quickSelect(
+    RandAccessIterator front, RandAccessIterator nth, RandAccessIterator back
+) {
+    int bad_allowed = badPartitionsAllowed(back - front);
+    bool leftmost = true;
+
+    while (back - front >= pdq_insertion_sort_threshold) {
+        const auto length = back - front;
+        choosePivot(front, back);
+
+        // Elements equal to the element before the list are already in place.
+        if (!leftmost && !(*(front - 1) < *front)) {
+            const auto pivot_position = partitionLeft(front, back);
+            if (nth <= pivot_position) {
+                return;
+            }
+            front = pivot_position + 1;
+            continue;
+        }
+
+        const auto pivot_position = partitionPivot(front, back);
+        if (pivot_position == nth) {
+            return;
+        }
+
+        const auto left_length = pivot_position - front;
+        const auto right_length = back - (pivot_position + 1);
+        if (
+            (left_length < length / 8 || right_length < length / 8)
+            && --bad_allowed == 0
+        ) {
+            pdqSort(front, back);
+            return;
+        }
+
+        // Continue in the part which contains nth.
+        if (nth < pivot_position) {
+            back = pivot_position;
+        } else {
+            front = pivot_position + 1;
+            leftmost = false;
+        }
+    }
+
+    insertionSort(front, back);
+}
+
+} // namespace
+
+
+/**
+ * Sorts the smallest elements of a list.
+ *
+ * Afterwards, [front, middle) holds the smallest middle - front elements in
+ * order, and [middle, back) holds the rest in no particular order. Quickselect
+ * finds the smallest elements in O(n) time on average, and only they are
+ * sorted, so this takes O(n + k log(k)) time for k = middle - front.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param middle A random access iterator to the back of the part to sort.
+ * @param back A random access iterator to the back of the list.
+ */
+template<class RandAccessIterator>
+void partialSort(
+    RandAccessIterator front,
+    RandAccessIterator middle,
+    RandAccessIterator back
+) {
+    if (middle == front) {
+        return;
+    }
+    if (middle != back) {
+        quickSelect(front, middle, back);
+    }
+    pdqSort(front, middle);
+}
+
+/**
+ * A view of a list which sorts it only as far as it is read.
+ *
+ * Reading the element at some position sorts the list up to that position and
+ * no further. This is incremental quicksort. A stack keeps the positions of
+ * pivots which have been placed beyond the sorted front. To extend the sorted
+ * front, the part between it and the nearest pivot is partitioned again,
+ * pushing new pivots, until the part is short enough for insertion sort. Then
+ * that part is done and its pivot is popped. Reading the first k of n
+ * elements takes O(n + k log(k)) time on average.
+ *
+ * The view rearranges the list it refers to.
+ */
+template<class RandAccessIterator>
+class SortedView {
+
+public:
+    using value_type =
+        typename std::iterator_traits<RandAccessIterator>::value_type;
+    using difference_type =
+        typename std::iterator_traits<RandAccessIterator>::difference_type;
+    using reference =
+        typename std::iterator_traits<RandAccessIterator>::reference;
+
+    /**
+     * An iterator over the view, which sorts as it goes.
+     */
+    class Iterator {
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = SortedView::value_type;
+        using difference_type = SortedView::difference_type;
+        using pointer = value_type *;
+        using reference = SortedView::reference;
+
+    private:
+        SortedView * view;
+        difference_type index;
+
+    public:
+        Iterator(SortedView * view, difference_type index):
+            view(view), index(index)
+        {
+        }
+
+        reference operator*(void) const {
+            return (*view)[index];
+        }
+
+        Iterator & operator++(void) {
+            ++index;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator copy(*this);
+            ++index;
+            return copy;
+        }
+
+        bool operator==(const Iterator & other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const Iterator & other) const {
+            return index != other.index;
+        }
+    };
+
+private:
+    RandAccessIterator front;
+    RandAccessIterator back;
+    /**
+     * The length of the sorted front.
+     */
+    difference_type sorted_length;
+    /**
+     * Positions of placed pivots, nearest last. No element before a pivot is
+     * greater than any element after it.
+     */
+    std::vector<difference_type> pivots;
+    int bad_allowed;
+
+public:
+    /**
+     * Constructs a view of a list. Nothing is sorted yet.
+     *
+     * @param front A random access iterator to the front of the list.
+     * @param back A random access iterator to the back of the list.
+     */
+    SortedView(RandAccessIterator front, RandAccessIterator back);
+
+    /**
+     * Sorts the list as far as needed and returns an element.
+     *
+     * @param i The position in sorted order.
+     * @return The element.
+     */
+    reference operator[](difference_type i);
+    Iterator begin(void);
+    Iterator end(void);
+    difference_type size(void) const;
+    /**
+     * @return The length of the front of the list which is sorted.
+     */
+    difference_type sortedLength(void) const;
+
+private:
+    /**
+     * Sorts the list up to and including a position.
+     */
+    void sortThrough(difference_type i);
+};
+
+
+template<class RandAccessIterator>
+SortedView<RandAccessIterator>::SortedView(
+    RandAccessIterator front, RandAccessIterator back
+):
+    front(front),
+    back(back),
+    sorted_length(0),
+    pivots{back - front},
+    bad_allowed(badPartitionsAllowed(back - front))
+{
+}
+
+template<class RandAccessIterator>
+typename SortedView<RandAccessIterator>::reference
+SortedView<RandAccessIterator>::operator[](difference_type i) {
+    if (i >= sorted_length) {
+        sortThrough(i);
+    }
+    return front[i];
+}
+
+template<class RandAccessIterator>
+typename SortedView<RandAccessIterator>::Iterator
+SortedView<RandAccessIterator>::begin(void) {
+    return Iterator(this, 0);
+}
+
+template<class RandAccessIterator>
+typename SortedView<RandAccessIterator>::Iterator
+SortedView<RandAccessIterator>::end(void) {
+    return Iterator(this, size());
+}
+
+template<class RandAccessIterator>
+typename SortedView<RandAccessIterator>::difference_type
+SortedView<RandAccessIterator>::size(void) const {
+    return back - front;
+}
+
+template<class RandAccessIterator>
+typename SortedView<RandAccessIterator>::difference_type
+SortedView<RandAccessIterator>::sortedLength(void) const {
+    return sorted_length;
+}
+
+template<class RandAccessIterator>
+void SortedView<RandAccessIterator>::sortThrough(difference_type i) {
+    while (sorted_length <= i) {
+        const auto part_front = front + sorted_length;
+        const auto part_back = front + pivots.back();
+        const auto length = part_back - part_front;
+
+        // Finish short parts with a simpler sorting algorithm.
+        if (length < pdq_insertion_sort_threshold) {
+            insertionSort(part_front, part_back);
+            sorted_length = pivots.back();
+            pivots.pop_back();
+            continue;
+        }
+
+        choosePivot(part_front, part_back);
+
+        // Elements equal to the last sorted element are already in place.
+        if (sorted_length > 0 && !(*(part_front - 1) < *part_front)) {
+            sorted_length = partitionLeft(part_front, part_back) - front + 1;
+            continue;
+        }
+
+        const auto pivot_position = partitionPivot(part_front, part_back);
+        const auto left_length = pivot_position - part_front;
+        const auto right_length = part_back - (pivot_position + 1);
+        if (
+            (left_length < length / 8 || right_length < length / 8)
+            && --bad_allowed <= 0
+        ) {
+            // Too many bad partitions. Sort the whole part instead.
+            pdqSort(part_front, part_back);
+            sorted_length = pivots.back();
+            pivots.pop_back();
+            continue;
+        }
+
+        pivots.push_back(pivot_position - front);
+    }
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "partial_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d, T2 e) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 6;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::setw(time_width) << std::setprecision(time_precision) << d
+            << std::setw(time_width) << std::setprecision(time_precision) << e
+            << std::endl;
+}
+
+/**
+ * Lists with patterns which are known to trouble quickselect.
+ */
+std::vector<std::vector<int>> testLists(size_t size) {
+    std::vector<int> sorted(size);
+    std::vector<int> reversed(size);
+    std::vector<int> few_unique = randomIntList(size);
+    for (size_t i = 0; i < size; ++i) {
+        sorted[i] = i;
+        reversed[i] = size - i;
+        few_unique[i] %= 4;
+    }
+    return {
+        randomIntList(size),
+        sorted,
+        reversed,
+        few_unique,
+        std::vector<int>(size, 42),
+    };
+}
+
+int main() {
+    // Test correctness.
+    for (size_t n : {0, 1, 2, 10, 23, 24, 100, 129, 1000, 100000}) {
+        for (const auto & list : testLists(n)) {
+            std::vector<int> expected = list;
+            std::sort(expected.begin(), expected.end());
+
+            const size_t one = std::min<size_t>(n, 1);
+            for (size_t k : {size_t(0), one, n / 3, n / 2, n}) {
+                std::vector<int> partial = list;
+                partialSort(
+                    partial.begin(), partial.begin() + k, partial.end()
+                );
+                assert(std::equal(
+                    partial.begin(), partial.begin() + k, expected.begin()
+                ));
+                std::sort(partial.begin() + k, partial.end());
+                assert(partial == expected);
+
+                // Reading a prefix sorts at least that much.
+                std::vector<int> viewed = list;
+                SortedView<std::vector<int>::iterator> view(
+                    viewed.begin(), viewed.end()
+                );
+                auto it = view.begin();
+                for (size_t i = 0; i < k; ++i, ++it) {
+                    assert(*it == expected[i]);
+                }
+                assert(view.sortedLength() >= static_cast<long>(k));
+                assert(std::equal(
+                    viewed.begin(), viewed.begin() + k, expected.begin()
+                ));
+            }
+
+            // Reading everything, out of order, sorts the list.
+            std::vector<int> viewed = list;
+            SortedView<std::vector<int>::iterator> view(
+                viewed.begin(), viewed.end()
+            );
+            if (n > 0) {
+                assert(view[n / 2] == expected[n / 2]);
+            }
+            std::vector<int> read(view.begin(), view.end());
+            assert(read == expected);
+            assert(viewed == expected);
+        }
+    }
+
+    // Non-arithmetic types.
+    std::vector<std::string> strings;
+    for (int value : randomIntList(10000)) {
+        strings.push_back(std::to_string(value % 5000));
+    }
+    std::vector<std::string> expected_strings = strings;
+    std::sort(expected_strings.begin(), expected_strings.end());
+    partialSort(strings.begin(), strings.begin() + 100, strings.end());
+    assert(std::equal(
+        strings.begin(), strings.begin() + 100, expected_strings.begin()
+    ));
+
+    // Test the speed of getting the k smallest of n elements in order.
+    constexpr long n = 10000000;
+    std::vector<int> unsorted = randomIntList(n);
+    printRow("k", "mergeSort()", "partial_sort()", "partialSort()", "view");
+    for (long k : {10, 1000, 100000, 1000000, 10000000}) {
+        double mergeSort_time = time([unsorted]() mutable {
+                mergeSort(unsorted.begin(), unsorted.end());
+                });
+
+        double std_time = time([unsorted, k]() mutable {
+                std::partial_sort(
+                    unsorted.begin(), unsorted.begin() + k, unsorted.end()
+                );
+                });
+
+        double partialSort_time = time([unsorted, k]() mutable {
+                partialSort(
+                    unsorted.begin(), unsorted.begin() + k, unsorted.end()
+                );
+                });
+
+        double view_time = time([unsorted, k]() mutable {
+                SortedView<std::vector<int>::iterator> view(
+                    unsorted.begin(), unsorted.end()
+                );
+                long sum = 0;
+                auto it = view.begin();
+                for (long i = 0; i < k; ++i, ++it) {
+                    sum += *it;
+                }
+                assert(sum != 0);
+                });
+
+        printRow(k, mergeSort_time, std_time, partialSort_time, view_time);
+    }
+
+    return 0;
+}
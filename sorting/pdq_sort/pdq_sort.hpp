@@ -0,0 +1,501 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "../insertion_sort/insertion_sort.hpp"
+#include "../shell_sort/shell_sort.hpp"
+
+
+namespace {
+
+/**
+ * Lists shorter than this are handed to insertion sort.
+ */
+constexpr long pdq_insertion_sort_threshold = 24;
+/**
+ * Lists longer than this use the median of three medians as the pivot.
+ */
+constexpr long pdq_ninther_threshold = 128;
+/**
+ * The number of moves after which partialInsertionSort() gives up.
+ */
+constexpr long pdq_partial_insertion_sort_limit = 8;
+/**
+ * The number of elements examined per block in block partitioning. Offsets
+ * within a block must fit in an unsigned char.
+ */
+constexpr long pdq_block_size = 64;
+
+/**
+ * Sorts two elements.
+ */
+template<class RandAccessIterator>
+void sortTwo(RandAccessIterator a, RandAccessIterator b) {
+    if (*b < *a) {
+        std::iter_swap(a, b);
+    }
+}
+
+/**
+ * Sorts three elements.
+ */
+template<class RandAccessIterator>
+void sortThree(
+    RandAccessIterator a, RandAccessIterator b, RandAccessIterator c
+) {
+    sortTwo(a, b);
+    sortTwo(b, c);
+    sortTwo(a, b);
+}
+
+/**
+ * Performs insertion sort, but gives up if too many elements are moved.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @return Whether the list was sorted.
+ */
+template<class RandAccessIterator>
+bool partialInsertionSort(RandAccessIterator front, RandAccessIterator back) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    if (front == back) {
+        return true;
+    }
+
+    long moves = 0;
+    for (auto unsorted = front + 1; unsorted != back; ++unsorted) {
+        auto sift = unsorted;
+        if (*sift < *(sift - 1)) {
+            value_type tmp_value = std::move(*sift);
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (sift != front && tmp_value < *(sift - 1));
+            *sift = std::move(tmp_value);
+            moves += unsorted - sift;
+        }
+        if (moves > pdq_partial_insertion_sort_limit) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Partitions a list around the pivot at the front, putting elements equal to
+ * the pivot on the left.
+ *
+ * The element before the front must not be greater than any element in the
+ * list, and must be equal to the pivot. Then every element equal to the pivot
+ * is already in its final position after partitioning.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @return The final position of the pivot.
+ */
+template<class RandAccessIterator>
+RandAccessIterator partitionLeft(
+    RandAccessIterator front, RandAccessIterator back
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    value_type pivot = std::move(*front);
+    auto left = front;
+    auto right = back;
+
+    while (pivot < *--right);
+    if (right + 1 == back) {
+        while (left < right && !(pivot < *++left));
+    } else {
+        while (!(pivot < *++left));
+    }
+
+    while (left < right) {
+        std::iter_swap(left, right);
+        while (pivot < *--right);
+        while (!(pivot < *++left));
+    }
+
+    *front = std::move(*right);
+    *right = std::move(pivot);
+    return right;
+}
+
+/**
+ * Partitions a list around the pivot at the front, putting elements equal to
+ * the pivot on the right.
+ *
+ * The element at the back minus one must not be less than the pivot.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @return The final position of the pivot and whether the list was already
+ * partitioned.
+ */
+template<class RandAccessIterator>
+std::pair<RandAccessIterator, bool> partitionRight(
+    RandAccessIterator front, RandAccessIterator back
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    value_type pivot = std::move(*front);
+    auto left = front;
+    auto right = back;
+
+    // Find the first pair of misplaced elements. If there is no smaller
+    // element on the left to stop the right scan, it must be bounded.
+    while (*++left < pivot);
+    if (left - 1 == front) {
+        while (left < right && !(*--right < pivot));
+    } else {
+        while (!(*--right < pivot));
+    }
+    const bool already_partitioned = left >= right;
+
+    while (left < right) {
+        std::iter_swap(left, right);
+        while (*++left < pivot);
+        while (!(*--right < pivot));
+    }
+
+    const auto pivot_position = left - 1;
+    *front = std::move(*pivot_position);
+    *pivot_position = std::move(pivot);
+    return std::make_pair(pivot_position, already_partitioned);
+}
+
+/**
+ * Swaps the misplaced elements recorded by block partitioning.
+ *
+ * @param left_base The position which the left offsets are relative to.
+ * @param right_base The position which the right offsets are relative to.
+ * @param left_offsets Offsets of elements to move right.
+ * @param right_offsets Offsets of elements to move left, counting backwards.
+ * @param count The number of pairs to swap.
+ * @param use_swaps Whether to swap pairs instead of rotating a cycle. This
+ * should be used when both sides have the same number of misplaced elements.
+ */
+template<class RandAccessIterator>
+void swapOffsets(
+    RandAccessIterator left_base,
+    RandAccessIterator right_base,
+    const unsigned char * left_offsets,
+    const unsigned char * right_offsets,
+    long count,
+    bool use_swaps
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    if (count == 0) {
+        return;
+    }
+
+    if (use_swaps) {
+        for (long i = 0; i < count; ++i) {
+            std::iter_swap(
+                left_base + left_offsets[i], right_base - right_offsets[i]
+            );
+        }
+        return;
+    }
+
+    // Otherwise, rotate the elements through a cycle instead of swapping
+    // pairs, which needs fewer moves.
+    auto left = left_base + left_offsets[0];
+    auto right = right_base - right_offsets[0];
+    value_type tmp_value = std::move(*left);
+    *left = std::move(*right);
+    for (long i = 1; i < count; ++i) {
+        left = left_base + left_offsets[i];
+        *right = std::move(*left);
+        right = right_base - right_offsets[i];
+        *left = std::move(*right);
+    }
+    *right = std::move(tmp_value);
+}
+
+/**
+ * Partitions a list like partitionRight(), but without branching on
+ * comparisons.
+ *
+ * Elements are compared a block at a time. The offsets of elements on the
+ * wrong side are recorded by always writing the offset and only advancing the
+ * count when the element is misplaced. The misplaced elements of the left and
+ * right blocks are then swapped. Comparison results do not control any
+ * branches, so the CPU cannot mispredict them. This is based on
+ * "BlockQuicksort: How Branch Mispredictions don't affect Quicksort" by Stefan
+ * Edelkamp and Armin Weiss.
+ *
+ * @see partitionRight(RandAccessIterator, RandAccessIterator)
+ */
+template<class RandAccessIterator>
+std::pair<RandAccessIterator, bool> partitionRightBranchless(
+    RandAccessIterator front, RandAccessIterator back
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    value_type pivot = std::move(*front);
+    auto left = front;
+    auto right = back;
+
+    while (*++left < pivot);
+    if (left - 1 == front) {
+        while (left < right && !(*--right < pivot));
+    } else {
+        while (!(*--right < pivot));
+    }
+    const bool already_partitioned = left >= right;
+
+    if (!already_partitioned) {
+        std::iter_swap(left, right);
+        ++left;
+
+        unsigned char left_offsets[pdq_block_size];
+        unsigned char right_offsets[pdq_block_size];
+        auto left_base = left;
+        auto right_base = right;
+        long left_count = 0;
+        long right_count = 0;
+        long left_start = 0;
+        long right_start = 0;
+
+        while (left < right) {
+            // Only refill a block once it has been used up. Split the
+            // remaining elements between the blocks which need refilling.
+            const long unknown = right - left;
+            const long left_split = left_count == 0
+                ? (right_count == 0 ? unknown / 2 : unknown)
+                : 0;
+            const long right_split = right_count == 0 ? unknown - left_split : 0;
+
+            const long left_limit = std::min(left_split, pdq_block_size);
+            for (long i = 0; i < left_limit; ++i) {
+                left_offsets[left_count] = static_cast<unsigned char>(i);
+                left_count += !(*left < pivot);
+                ++left;
+            }
+            const long right_limit = std::min(right_split, pdq_block_size);
+            for (long i = 1; i <= right_limit; ++i) {
+                --right;
+                right_offsets[right_count] = static_cast<unsigned char>(i);
+                right_count += *right < pivot;
+            }
+
+            const long count = std::min(left_count, right_count);
+            swapOffsets(
+                left_base,
+                right_base,
+                left_offsets + left_start,
+                right_offsets + right_start,
+                count,
+                left_count == right_count
+            );
+            left_count -= count;
+            right_count -= count;
+            left_start += count;
+            right_start += count;
+            if (left_count == 0) {
+                left_start = 0;
+                left_base = left;
+            }
+            if (right_count == 0) {
+                right_start = 0;
+                right_base = right;
+            }
+        }
+
+        // At most one block has leftover misplaced elements. Move them to the
+        // boundary.
+        if (left_count > 0) {
+            while (left_count > 0) {
+                --left_count;
+                --right;
+                std::iter_swap(
+                    left_base + left_offsets[left_start + left_count], right
+                );
+            }
+            left = right;
+        }
+        if (right_count > 0) {
+            while (right_count > 0) {
+                --right_count;
+                std::iter_swap(
+                    right_base - right_offsets[right_start + right_count], left
+                );
+                ++left;
+            }
+        }
+    }
+
+    const auto pivot_position = left - 1;
+    *front = std::move(*pivot_position);
+    *pivot_position = std::move(pivot);
+    return std::make_pair(pivot_position, already_partitioned);
+}
+
+/**
+ * Helper function for performing pattern-defeating quicksort.
+ *
+ * @param front An iterator to the front of the list.
+ * @param back An iterator to the back of the list.
+ * @param bad_allowed The number of badly unbalanced partitions allowed before
+ * falling back to Shell sort.
+ * @param leftmost Whether the list is the leftmost part of the whole list. If
+ * not, the element before the front is not greater than any element in the
+ * list.
+ */
+template<bool branchless, class RandAccessIterator>
+void _pdqSort(
+    RandAccessIterator front,
+    RandAccessIterator back,
+    int bad_allowed,
+    bool leftmost
+) {
+    while (true) {
+        const auto length = back - front;
+
+        // Use a simpler sorting algorithm for the last part to improve speed.
+        if (length < pdq_insertion_sort_threshold) {
+            insertionSort(front, back);
+            return;
+        }
+
+        // Choose the pivot as the median of three, or the median of three
+        // medians of three for long lists, and move it to the front.
+        const auto half = length / 2;
+        if (length > pdq_ninther_threshold) {
+            sortThree(front, front + half, back - 1);
+            sortThree(front + 1, front + (half - 1), back - 2);
+            sortThree(front + 2, front + (half + 1), back - 3);
+            sortThree(front + (half - 1), front + half, front + (half + 1));
+            std::iter_swap(front, front + half);
+        } else {
+            sortThree(front + half, front, back - 1);
+        }
+
+        // If the pivot equals the element before the list, the pivot is the
+        // smallest value. Group the elements equal to it, which are then done,
+        // and only continue with the larger elements.
+        if (!leftmost && !(*(front - 1) < *front)) {
+            front = partitionLeft(front, back) + 1;
+            continue;
+        }
+
+        const auto partition = branchless
+            ? partitionRightBranchless(front, back)
+            : partitionRight(front, back);
+        const auto pivot_position = partition.first;
+        const bool already_partitioned = partition.second;
+
+        const auto left_length = pivot_position - front;
+        const auto right_length = back - (pivot_position + 1);
+        const bool unbalanced =
+            left_length < length / 8 || right_length < length / 8;
+
+        if (unbalanced) {
+            // Too many bad partitions means an adversarial pattern. Switch to
+            // an algorithm with a bounded worst case.
+            if (--bad_allowed == 0) {
+                shellSort(front, back);
+                return;
+            }
+
+            // Break up patterns by swapping some elements around.
+            if (left_length >= pdq_insertion_sort_threshold) {
+                std::iter_swap(front, front + left_length / 4);
+                std::iter_swap(
+                    pivot_position - 1, pivot_position - left_length / 4
+                );
+                if (left_length > pdq_ninther_threshold) {
+                    std::iter_swap(front + 1, front + (left_length / 4 + 1));
+                    std::iter_swap(front + 2, front + (left_length / 4 + 2));
+                    std::iter_swap(
+                        pivot_position - 2,
+                        pivot_position - (left_length / 4 + 1)
+                    );
+                    std::iter_swap(
+                        pivot_position - 3,
+                        pivot_position - (left_length / 4 + 2)
+                    );
+                }
+            }
+            if (right_length >= pdq_insertion_sort_threshold) {
+                std::iter_swap(
+                    pivot_position + 1, pivot_position + (1 + right_length / 4)
+                );
+                std::iter_swap(back - 1, back - right_length / 4);
+                if (right_length > pdq_ninther_threshold) {
+                    std::iter_swap(
+                        pivot_position + 2,
+                        pivot_position + (2 + right_length / 4)
+                    );
+                    std::iter_swap(
+                        pivot_position + 3,
+                        pivot_position + (3 + right_length / 4)
+                    );
+                    std::iter_swap(back - 2, back - (1 + right_length / 4));
+                    std::iter_swap(back - 3, back - (2 + right_length / 4));
+                }
+            }
+        } else if (
+            already_partitioned
+            && partialInsertionSort(front, pivot_position)
+            && partialInsertionSort(pivot_position + 1, back)
+        ) {
+            // A balanced partition which needed no swaps suggests the list is
+            // (nearly) sorted, and it was.
+            return;
+        }
+
+        // Recurse on the left part and loop on the right part.
+        _pdqSort<branchless>(front, pivot_position, bad_allowed, leftmost);
+        front = pivot_position + 1;
+        leftmost = false;
+    }
+}
+
+} // namespace
+
+
+/**
+ * Perform pattern-defeating quicksort on a list.
+ *
+ * This is an unstable in-place sort. It runs in O(n log(n)) time on typical
+ * inputs and in linear time on sorted lists and lists of few distinct values.
+ * Arithmetic types are partitioned without branching on comparisons. Lists
+ * which keep producing bad partitions are finished with Shell sort.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ */
+template<class RandAccessIterator>
+void pdqSort(RandAccessIterator front, RandAccessIterator back) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const auto length = back - front;
+    if (length <= 1) {
+        return;
+    }
+
+    // Allow about log2(n) bad partitions.
+    int bad_allowed = 0;
+    for (auto remaining = length; remaining > 0; remaining /= 2) {
+        ++bad_allowed;
+    }
+
+    _pdqSort<std::is_arithmetic<value_type>::value>(
+        front, back, bad_allowed, true
+    );
+}
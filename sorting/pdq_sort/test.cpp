@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "pdq_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c) {
+    constexpr int n_width = 14;
+    constexpr int time_precision = 8;
+    constexpr int time_width = 12;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::endl;
+}
+
+/**
+ * Creates a list which makes median-of-3 quicksort quadratic.
+ *
+ * @param size The list size. Must be even.
+ * @return The list.
+ */
+std::vector<int> medianOf3KillerList(size_t size) {
+    std::vector<int> list(size);
+    const size_t k = size / 2;
+
+    for (size_t i = 1; i <= k; ++i) {
+        if (i % 2 == 1) {
+            list[i - 1] = i;
+            list[i] = k + i;
+        }
+        list[k + i - 1] = 2 * i;
+    }
+
+    return list;
+}
+
+/**
+ * Lists with patterns which are known to trouble quicksort.
+ */
+std::vector<std::pair<std::string, std::function<std::vector<int>(size_t)>>>
+patterns = {
+    {"random", randomIntList},
+    {"sorted", [](size_t size) {
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; ++i) {
+            list[i] = i;
+        }
+        return list;
+    }},
+    {"reversed", [](size_t size) {
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; ++i) {
+            list[i] = size - i;
+        }
+        return list;
+    }},
+    {"equal", [](size_t size) {
+        return std::vector<int>(size, 42);
+    }},
+    {"few_unique", [](size_t size) {
+        std::vector<int> list = randomIntList(size);
+        for (auto & value : list) {
+            value %= 4;
+        }
+        return list;
+    }},
+    {"organ_pipe", [](size_t size) {
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; ++i) {
+            list[i] = std::min(i, size - i);
+        }
+        return list;
+    }},
+    {"sawtooth", [](size_t size) {
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; ++i) {
+            list[i] = i % 1000;
+        }
+        return list;
+    }},
+    {"sorted_tail", [](size_t size) {
+        std::vector<int> list(size);
+        for (size_t i = 0; i < size; ++i) {
+            list[i] = i;
+        }
+        if (size > 0) {
+            list.back() = 0;
+        }
+        return list;
+    }},
+    {"median3_killer", [](size_t size) {
+        return medianOf3KillerList(size - size % 2);
+    }},
+};
+
+int main() {
+    // Test correctness.
+    for (const auto & pattern : patterns) {
+        for (size_t n : {0, 1, 2, 3, 10, 23, 24, 100, 129, 1000, 100000}) {
+            std::vector<int> sort_me = pattern.second(n);
+            std::vector<int> expected = sort_me;
+            std::sort(expected.begin(), expected.end());
+            pdqSort(sort_me.begin(), sort_me.end());
+            assert(sort_me == expected);
+        }
+    }
+
+    // Non-arithmetic types use the branching partition.
+    std::vector<std::string> strings;
+    for (int value : randomIntList(10000)) {
+        strings.push_back(std::to_string(value % 5000));
+    }
+    pdqSort(strings.begin(), strings.end());
+    assert(isSorted(strings.cbegin(), strings.cend()));
+
+    // Test speed.
+    constexpr long pattern_length = 10000000;
+    printRow("pattern", "sort()", "pdqSort()");
+    for (const auto & pattern : patterns) {
+        std::vector<int> unsorted = pattern.second(pattern_length);
+
+        double pdqSort_time = time([unsorted]() mutable {
+                pdqSort(unsorted.begin(), unsorted.end());
+                });
+
+        double sort_time = time([unsorted]() mutable {
+                std::sort(unsorted.begin(), unsorted.end());
+                });
+
+        printRow(pattern.first, sort_time, pdqSort_time);
+    }
+
+    printRow("n", "sort()", "pdqSort()");
+    for (long n : {100, 1000, 10000, 100000, 1000000, 10000000, 100000000}) {
+        std::vector<int> unsorted = randomIntList(n);
+
+        double pdqSort_time = time([unsorted]() mutable {
+                pdqSort(unsorted.begin(), unsorted.end());
+                });
+
+        double sort_time = time([unsorted]() mutable {
+                std::sort(unsorted.begin(), unsorted.end());
+                });
+
+        printRow(n, sort_time, pdqSort_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../libraries/sorting_network.hpp"
+#include "../merge_sort/merge_sort.hpp"
+
+
+namespace {
+
+/**
+ * The longest segments which are sorted with a sorting network. Longer ones
+ * are sorted with merge sort.
+ */
+constexpr std::size_t segment_network_limit = network_sort_limit;
+
+/**
+ * Performs merge sort on a segment, with sorting networks for the shortest
+ * parts.
+ *
+ * @param front An iterator to the front of the segment.
+ * @param buffer A pointer to the front of the buffer.
+ * @param length The segment length.
+ * @return Whether the sorted segment is in the buffer.
+ * @see _mergeSort(RandAccessIterator, typename std::iterator_traits<RandAccessIterator>::value_type *, typename std::iterator_traits<RandAccessIterator>::difference_type)
+ */
+template<class RandAccessIterator>
+bool segmentMergeSort(
+    RandAccessIterator front,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer,
+    typename std::iterator_traits<RandAccessIterator>::difference_type length
+) {
+    if (length <= static_cast<long>(segment_network_limit)) {
+        networkSort(front, length);
+        return false;
+    }
+
+    const auto left_length = length / 2;
+    const bool left_in_buffer = segmentMergeSort(front, buffer, left_length);
+    const bool right_in_buffer = segmentMergeSort(
+        front + left_length, buffer + left_length, length - left_length
+    );
+    // The parentheses stop argument-dependent lookup, which would find
+    // std::merge() for raw pointers to standard types.
+    return (merge)(
+        front, buffer, left_length, length, left_in_buffer, right_in_buffer
+    );
+}
+
+/**
+ * The work to sort a segment, roughly proportional to n log(n).
+ */
+std::size_t segmentCost(std::size_t length) {
+    std::size_t log_length = 1;
+    for (std::size_t remaining = length; remaining > 1; remaining /= 2) {
+        ++log_length;
+    }
+    return length * log_length;
+}
+
+/**
+ * Sorts a range of segments from the grouped order.
+ *
+ * @param front An iterator to the front of the list.
+ * @param offsets The segment boundaries.
+ * @param segments_front A pointer to the front of the indices of the segments
+ * to sort.
+ * @param segments_back A pointer to the back of the indices.
+ * @param buffer A pointer to a buffer as long as the longest segment which is
+ * sorted with merge sort.
+ */
+template<class RandAccessIterator>
+void sortSegments(
+    RandAccessIterator front,
+    const std::vector<std::size_t> & offsets,
+    const std::size_t * segments_front,
+    const std::size_t * segments_back,
+    typename std::iterator_traits<RandAccessIterator>::value_type * buffer
+) {
+    for (auto segment = segments_front; segment < segments_back; ++segment) {
+        const auto segment_front = front + offsets[*segment];
+        const std::size_t length = offsets[*segment + 1] - offsets[*segment];
+
+        if (length <= segment_network_limit) {
+            networkSort(segment_front, length);
+        } else if (segmentMergeSort(segment_front, buffer, length)) {
+            std::move(buffer, buffer + length, segment_front);
+        }
+    }
+}
+
+} // namespace
+
+
+/**
+ * Sorts many independent segments of a list in one call.
+ *
+ * Segment i is [front + offsets[i], front + offsets[i + 1]). Segments are
+ * bucketed by length with a stable counting sort on their indices. Segments of
+ * up to segment_network_limit elements are sorted with sorting networks, and
+ * longer segments with the buffered merge sort, whose shortest parts are also
+ * sorted with sorting networks. Within a bucket, segments stay in list order,
+ * so memory is read front to back.
+ *
+ * The bucketed segments are split into one contiguous range per thread, with
+ * about the same amount of work in each. All threads share one workspace
+ * allocation, in which each thread gets a slice as long as its longest merge
+ * sorted segment. Nothing else is allocated per segment.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param offsets The segment boundaries, in increasing order. The first is
+ * usually 0 and the last the list length.
+ * @param threads The number of threads. Zero means one per hardware thread.
+ */
+template<class RandAccessIterator>
+void segmentedSort(
+    RandAccessIterator front,
+    const std::vector<std::size_t> & offsets,
+    unsigned threads = 0
+) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    if (offsets.size() < 2) {
+        return;
+    }
+    const std::size_t segment_count = offsets.size() - 1;
+
+    // Bucket 0 holds segments which are already sorted, bucket 1 segments for
+    // sorting networks and bucket 2 segments for merge sort.
+    constexpr std::size_t bucket_count = 3;
+    auto bucket = [&](std::size_t segment) -> std::size_t {
+        const std::size_t length = offsets[segment + 1] - offsets[segment];
+        return (length > 1) + (length > segment_network_limit);
+    };
+    std::size_t bucket_fronts[bucket_count + 1] = {0};
+    std::size_t max_merge_length = 0;
+    for (std::size_t segment = 0; segment < segment_count; ++segment) {
+        const std::size_t b = bucket(segment);
+        ++bucket_fronts[b + 1];
+        if (b == 2) {
+            max_merge_length = std::max(
+                max_merge_length, offsets[segment + 1] - offsets[segment]
+            );
+        }
+    }
+    for (std::size_t b = 0; b < bucket_count; ++b) {
+        bucket_fronts[b + 1] += bucket_fronts[b];
+    }
+
+    const std::size_t skipped = bucket_fronts[1];
+    std::vector<std::size_t> order(segment_count);
+    for (std::size_t segment = 0; segment < segment_count; ++segment) {
+        order[bucket_fronts[bucket(segment)]++] = segment;
+    }
+    const std::size_t * order_front = order.data() + skipped;
+    const std::size_t * order_back = order.data() + segment_count;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<std::size_t>(
+        1, std::min<std::size_t>(threads, order_back - order_front)
+    );
+    if (threads == 1) {
+        std::unique_ptr<value_type[]> buffer(new value_type[max_merge_length]);
+        sortSegments(front, offsets, order_front, order_back, buffer.get());
+        return;
+    }
+
+    // Split the bucketed segments into ranges with about equal work.
+    std::size_t total_cost = 0;
+    for (auto segment = order_front; segment < order_back; ++segment) {
+        total_cost += segmentCost(offsets[*segment + 1] - offsets[*segment]);
+    }
+
+    std::vector<const std::size_t *> splits(threads + 1, order_back);
+    std::vector<std::size_t> buffer_lengths(threads, 0);
+    splits[0] = order_front;
+    std::size_t cost = 0;
+    unsigned t = 0;
+    for (auto segment = order_front; segment < order_back; ++segment) {
+        while (t + 1 < threads && cost >= total_cost * (t + 1) / threads) {
+            splits[++t] = segment;
+        }
+        const std::size_t length = offsets[*segment + 1] - offsets[*segment];
+        cost += segmentCost(length);
+        if (length > segment_network_limit) {
+            buffer_lengths[t] = std::max(buffer_lengths[t], length);
+        }
+    }
+
+    // One workspace, sliced between the threads.
+    std::vector<std::size_t> buffer_fronts(threads + 1, 0);
+    for (t = 0; t < threads; ++t) {
+        buffer_fronts[t + 1] = buffer_fronts[t] + buffer_lengths[t];
+    }
+    std::unique_ptr<value_type[]> buffer(
+        new value_type[buffer_fronts[threads]]
+    );
+
+    std::vector<std::thread> workers;
+    for (t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            sortSegments(
+                front,
+                offsets,
+                splits[t],
+                splits[t + 1],
+                buffer.get() + buffer_fronts[t]
+            );
+        });
+    }
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "segmented_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d, T2 e) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 6;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::setw(time_width) << std::setprecision(time_precision) << d
+            << std::setw(time_width) << std::setprecision(time_precision) << e
+            << std::endl;
+}
+
+/**
+ * Creates segment boundaries with random lengths.
+ *
+ * @param size The list size.
+ * @param min_length The shortest segment length.
+ * @param max_length The longest segment length.
+ * @return The boundaries, starting with 0 and ending with the list size.
+ */
+std::vector<size_t> randomOffsets(
+    size_t size, size_t min_length, size_t max_length
+) {
+    std::default_random_engine r_engine;
+    std::uniform_int_distribution<size_t> r_distr(min_length, max_length);
+
+    std::vector<size_t> offsets = {0};
+    while (offsets.back() < size) {
+        offsets.push_back(std::min(size, offsets.back() + r_distr(r_engine)));
+    }
+    return offsets;
+}
+
+/**
+ * Sorts each segment separately with std::sort().
+ */
+template<class RandAccessIterator>
+void sortEachSegment(
+    RandAccessIterator front, const std::vector<size_t> & offsets
+) {
+    for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+        std::sort(front + offsets[i], front + offsets[i + 1]);
+    }
+}
+
+int main() {
+    // Test correctness.
+    for (size_t max_length : {1, 2, 8, 9, 16, 17, 200, 5000}) {
+        for (unsigned threads : {1u, 2u, 3u, 8u}) {
+            const std::vector<size_t> offsets =
+                randomOffsets(20000, 0, max_length);
+            std::vector<int> sort_me = randomIntList(20000);
+            for (auto & value : sort_me) {
+                value %= 100;
+            }
+            std::vector<int> expected = sort_me;
+            sortEachSegment(expected.begin(), offsets);
+            segmentedSort(sort_me.begin(), offsets, threads);
+            assert(sort_me == expected);
+        }
+    }
+
+    // Offsets need not start at zero or cover the whole list.
+    std::vector<int> partly = randomIntList(100);
+    std::vector<int> expected_partly = partly;
+    const std::vector<size_t> inner_offsets = {10, 12, 50, 90};
+    sortEachSegment(expected_partly.begin(), inner_offsets);
+    segmentedSort(partly.begin(), inner_offsets);
+    assert(partly == expected_partly);
+    segmentedSort(partly.begin(), {});
+    segmentedSort(partly.begin(), {5});
+
+    // Non-arithmetic types.
+    std::vector<std::string> strings;
+    for (int value : randomIntList(10000)) {
+        strings.push_back(std::to_string(value % 5000));
+    }
+    const std::vector<size_t> string_offsets = randomOffsets(10000, 1, 100);
+    std::vector<std::string> expected_strings = strings;
+    sortEachSegment(expected_strings.begin(), string_offsets);
+    segmentedSort(strings.begin(), string_offsets, 4);
+    assert(strings == expected_strings);
+
+    // Raw pointers to standard types.
+    std::vector<std::string> raw_strings = expected_strings;
+    std::reverse(raw_strings.begin(), raw_strings.end());
+    std::vector<std::string> expected_raw = raw_strings;
+    sortEachSegment(expected_raw.begin(), {0, 20, 10000});
+    segmentedSort(raw_strings.data(), {0, 20, 10000});
+    assert(raw_strings == expected_raw);
+
+    // Test speed.
+    constexpr long list_length = 20000000;
+    const unsigned hardware_threads =
+        std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> unsorted = randomIntList(list_length);
+    printRow("lengths", "sort()", "mergeSort()", "segmented", "threads");
+    for (size_t max_length : {8, 32, 200, 2000}) {
+        const std::vector<size_t> offsets =
+            randomOffsets(list_length, 2, max_length);
+
+        double sort_time = time([unsorted, &offsets]() mutable {
+                sortEachSegment(unsorted.begin(), offsets);
+                });
+
+        double mergeSort_time = time([unsorted, &offsets]() mutable {
+                for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+                    mergeSort(
+                        unsorted.begin() + offsets[i],
+                        unsorted.begin() + offsets[i + 1]
+                    );
+                }
+                });
+
+        double segmented_time = time([unsorted, &offsets]() mutable {
+                segmentedSort(unsorted.begin(), offsets, 1);
+                });
+
+        double threads_time = time([unsorted, &offsets]() mutable {
+                segmentedSort(unsorted.begin(), offsets);
+                });
+
+        printRow(
+            "2-" + std::to_string(max_length),
+            sort_time,
+            mergeSort_time,
+            segmented_time,
+            threads_time
+        );
+    }
+    std::cout << "threads: " << hardware_threads << std::endl;
+
+    return 0;
+}
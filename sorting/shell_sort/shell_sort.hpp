@@ -1,4 +1,4 @@
-#include <vector>
+#pragma once
 
 #include "../insertion_sort/insertion_sort.hpp"
 #include "../../libraries/skip_iterator.hpp"
@@ -6,32 +6,41 @@
 
 namespace {
 
+/**
+ * More than enough Sedgewick gaps for any list which fits in memory.
+ */
+constexpr int sedgewick_gap_capacity = 64;
+
 /**
  * Computes Sedgewick's gap numbers.
  *
+ * The gaps are written to a fixed-size array instead of a vector, so that they
+ * can be computed at compile time.
+ *
  * @param limit The maximum gap needed. Must be at least 1.
- * @return The gap numbers from smallest to largest.
+ * @param gaps Where to write the gap numbers, from smallest to largest.
+ * @return The number of gaps.
  */
-std::vector<long> sedgewickGaps(long limit) {
-    std::vector<long> gaps;
+constexpr int sedgewickGaps(long limit, long (&gaps)[sedgewick_gap_capacity]) {
+    int gap_count = 0;
     long pow_2 = 1;
     long pow_4 = 1;
 
     // Sedgewick's numbers alternate between two formulas. Keep calculating them
     // until we meet or exceed the limit.
     do {
-        gaps.push_back(9 * (pow_4 - pow_2) + 1);
-        gaps.push_back(pow_2 * (16 * pow_2 - 12) + 1);
+        gaps[gap_count++] = 9 * (pow_4 - pow_2) + 1;
+        gaps[gap_count++] = pow_2 * (16 * pow_2 - 12) + 1;
         pow_2 *= 2;
         pow_4 *= 4;
-    } while (gaps.back() < limit);
+    } while (gaps[gap_count - 1] < limit);
 
     // Backtrack if needed.
-    while (gaps.back() > limit) {
-        gaps.pop_back();
+    while (gaps[gap_count - 1] > limit) {
+        --gap_count;
     }
 
-    return gaps;
+    return gap_count;
 }
 
 }
@@ -44,27 +53,28 @@ std::vector<long> sedgewickGaps(long limit) {
  * @param back A random access iterator to the back of the list.
  */
 template<class RandAccessIterator>
-void shellSort(RandAccessIterator front, RandAccessIterator back) {
+constexpr void shellSort(RandAccessIterator front, RandAccessIterator back) {
     if (back - front <= 1) {
         return;
     }
 
     const auto length = back - front;
-    const std::vector<long> gaps = sedgewickGaps(length - 1);
+    long gaps[sedgewick_gap_capacity] = {};
+    const int gap_count = sedgewickGaps(length - 1, gaps);
 
     SkipIterator<RandAccessIterator> sub_front, sub_back;
-    for (int gap_index = gaps.size() - 1; gap_index >= 0; gap_index--) {
+    for (int gap_index = gap_count - 1; gap_index >= 0; gap_index--) {
         const auto & gap = gaps[gap_index];
         sub_front.setSpacing(gap);
         sub_back.setSpacing(gap);
 
-        // Perform insertion sort for each possible offset.
+        // Perform insertion sort for each possible offset. The back of each
+        // sub-list may lie past the back of the list, so it is reached by
+        // skipping from the front instead of being set directly.
         for (int offset = 0; offset < gap; offset++) {
-            const auto first_iter = front + offset;
-            const auto last_iter =
-                first_iter + ((length - 1 - offset) / gap + 1) * gap;
-            sub_front.set(first_iter);
-            sub_back.set(last_iter);
+            sub_front.set(front + offset);
+            sub_back = sub_front;
+            sub_back += (length - 1 - offset) / gap + 1;
 
             insertionSort(sub_front, sub_back);
         }
@@ -1,8 +1,10 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <string_view>
 #include <vector>
 
 #include "../../test_utils.hpp"
@@ -24,6 +26,41 @@ void printRow(T1 a, T2 b, T2 c) {
             << std::endl;
 }
 
+constexpr std::array<std::string_view, 12> keywords = {
+    "while", "auto", "if", "return", "do", "for",
+    "break", "else", "switch", "case", "continue", "const",
+};
+
+/**
+ * Sorts a copy of a table with both insertionSort() and shellSort().
+ *
+ * @return Whether both sorts produced the same sorted table as expected.
+ */
+template<class T, std::size_t size>
+constexpr bool sortsMatch(
+    std::array<T, size> table, const std::array<T, size> & expected
+) {
+    std::array<T, size> copy = table;
+    insertionSort(table.begin(), table.end());
+    shellSort(copy.begin(), copy.end());
+
+    for (std::size_t i = 0; i < size; ++i) {
+        if (table[i] != expected[i] || copy[i] != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Sorts a table with shellSort().
+ */
+template<class T, std::size_t size>
+constexpr std::array<T, size> shellSorted(std::array<T, size> table) {
+    shellSort(table.begin(), table.end());
+    return table;
+}
+
 int main() {
     std::vector<int> sort_me = randomIntList(1000);
 
@@ -32,6 +69,29 @@ int main() {
     shellSort(sort_me.begin(), sort_me.end());
     assert(isSorted(sort_me.cbegin(), sort_me.cend()));
 
+    // Test sorting at compile time, and that the result matches sorting the
+    // same table at run time.
+    constexpr auto int_table = constexprIntTable<300>();
+    constexpr auto sorted_int_table = shellSorted(int_table);
+    static_assert(isSorted(sorted_int_table.begin(), sorted_int_table.end()));
+    static_assert(sortsMatch(int_table, sorted_int_table));
+    assert(sortsMatch(int_table, sorted_int_table));
+    std::vector<int> runtime_table(int_table.begin(), int_table.end());
+    shellSort(runtime_table.begin(), runtime_table.end());
+    assert(std::equal(
+        runtime_table.begin(), runtime_table.end(), sorted_int_table.begin()
+    ));
+
+    constexpr auto sorted_keywords = shellSorted(keywords);
+    static_assert(sorted_keywords.front() == "auto");
+    static_assert(sorted_keywords.back() == "while");
+    static_assert(isSorted(sorted_keywords.begin(), sorted_keywords.end()));
+    static_assert(sortsMatch(keywords, sorted_keywords));
+    assert(sortsMatch(keywords, sorted_keywords));
+
+    static_assert(sortsMatch(std::array<int, 1>{7}, {7}));
+    static_assert(sortsMatch(std::array<int, 2>{7, 3}, {3, 7}));
+
     // Test speed.
     printRow("n", "sort()", "shellSort()");
     for (long n : {0, 1, 10, 100, 1000, 10000, 100000, 1000000}) {
@@ -1,9 +1,39 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <random>
 #include <vector>
 
 
+/**
+ * An int with a tag which does not take part in ordering, to check stability.
+ */
+struct Tagged {
+    int value;
+    int tag;
+
+    bool operator<(const Tagged & other) const {
+        return value < other.value;
+    }
+
+    bool operator<=(const Tagged & other) const {
+        return value <= other.value;
+    }
+
+    bool operator>(const Tagged & other) const {
+        return value > other.value;
+    }
+
+    /**
+     * Equality includes the tag, so that comparing two lists also compares
+     * the order of equal values.
+     */
+    bool operator==(const Tagged & other) const {
+        return value == other.value && tag == other.tag;
+    }
+};
+
 /**
  * Checks if the list is sorted in ascending order.
  *
@@ -12,7 +42,7 @@
  * @return Whether the list is sorted or not.
  */
 template<class RandAccessIterator>
-bool isSorted(RandAccessIterator front, RandAccessIterator back) {
+constexpr bool isSorted(RandAccessIterator front, RandAccessIterator back) {
     auto current = front;
     auto next = front + 1;
 
@@ -43,3 +73,22 @@ std::vector<int> randomIntList(size_t size) {
 
     return list;
 }
+
+/**
+ * Creates a table of pseudo-random ints at compile time.
+ *
+ * The values come from a linear congruential generator with a fixed seed, so
+ * every call returns the same table.
+ *
+ * @return The table, with values from 0 to 999.
+ */
+template<std::size_t size>
+constexpr std::array<int, size> constexprIntTable() {
+    std::array<int, size> table = {};
+    unsigned long state = 12345;
+    for (auto & value : table) {
+        state = state * 6364136223846793005UL + 1442695040888963407UL;
+        value = static_cast<int>((state >> 33) % 1000);
+    }
+    return table;
+}
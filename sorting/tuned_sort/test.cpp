@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.hpp"
+#include "../test_utils.hpp"
+#include "tuned_sort.hpp"
+
+
+template<typename T1, typename T2>
+void printRow(T1 a, T2 b, T2 c, T2 d) {
+    constexpr int n_width = 10;
+    constexpr int time_precision = 6;
+    constexpr int time_width = 16;
+    std::cout
+            << std::fixed
+            << std::setw(n_width) << a
+            << std::setw(time_width) << std::setprecision(time_precision) << b
+            << std::setw(time_width) << std::setprecision(time_precision) << c
+            << std::setw(time_width) << std::setprecision(time_precision) << d
+            << std::endl;
+}
+
+void printThresholds(const std::string & name, const SortThresholds & t) {
+    std::cout << name
+        << ": network " << t.network_limit
+        << ", insertion " << t.insertion_limit
+        << ", shell " << t.shell_limit
+        << ", stable insertion " << t.stable_insertion_limit
+        << std::endl;
+}
+
+/**
+ * Sorts many lists of one size and returns the total time.
+ */
+template<class Sort>
+double timeManyLists(const std::vector<int> & lists, long size, Sort sort) {
+    std::vector<int> work = lists;
+    return time([&]() {
+        for (auto front = work.begin(); front < work.end(); front += size) {
+            sort(front, front + size);
+        }
+    });
+}
+
+int main() {
+    // Test correctness with thresholds which use every algorithm.
+    SortConfig & config = sortConfig();
+    config.arithmetic = {4, 10, 100, 10};
+    config.other = {4, 10, 100, 10};
+    for (size_t n : {0, 1, 2, 4, 5, 10, 11, 100, 101, 10000}) {
+        std::vector<int> sort_me = randomIntList(n);
+        std::vector<int> expected = sort_me;
+        std::sort(expected.begin(), expected.end());
+        tunedSort(sort_me.begin(), sort_me.end());
+        assert(sort_me == expected);
+
+        std::vector<std::string> strings;
+        for (int value : randomIntList(n)) {
+            strings.push_back(std::to_string(value % 1000));
+        }
+        std::vector<std::string> expected_strings = strings;
+        std::sort(expected_strings.begin(), expected_strings.end());
+        tunedSort(strings.begin(), strings.end());
+        assert(strings == expected_strings);
+
+        std::vector<Tagged> tagged;
+        for (int value : randomIntList(n)) {
+            tagged.push_back({value % 10, static_cast<int>(tagged.size())});
+        }
+        tunedStableSort(tagged.begin(), tagged.end());
+        for (size_t i = 1; i < tagged.size(); ++i) {
+            assert(
+                tagged[i - 1].value < tagged[i].value
+                || (
+                    tagged[i - 1].value == tagged[i].value
+                    && tagged[i - 1].tag < tagged[i].tag
+                )
+            );
+        }
+    }
+
+    // Test saving and loading.
+    const std::string path = "tuned_sort_test.conf";
+    const SortConfig saved = {{6, 7, 50, 9}, {2, 3, 4, 5}};
+    saveSortConfig(path, saved);
+    SortConfig loaded;
+    assert(loadSortConfig(path, loaded));
+    assert(loaded.arithmetic.network_limit == 6);
+    assert(loaded.arithmetic.insertion_limit == 7);
+    assert(loaded.arithmetic.shell_limit == 50);
+    assert(loaded.arithmetic.stable_insertion_limit == 9);
+    assert(loaded.other.network_limit == 2);
+    assert(loaded.other.insertion_limit == 3);
+    assert(loaded.other.shell_limit == 4);
+    assert(loaded.other.stable_insertion_limit == 5);
+
+    // Missing thresholds keep their defaults.
+    std::ofstream(path) << "# Partial\n\narithmetic.shell_limit 64\n";
+    assert(loadSortConfig(path, loaded));
+    const SortThresholds default_thresholds;
+    assert(loaded.arithmetic.shell_limit == 64);
+    assert(
+        loaded.arithmetic.insertion_limit
+        == default_thresholds.insertion_limit
+    );
+    assert(loaded.other.shell_limit == default_thresholds.shell_limit);
+
+    for (const char * bad : {
+        "arithmetic.insertion_limit\n",
+        "arithmetic.insertion_limit x\n",
+        "arithmetic.insertion_limit 1 2\n",
+        "arithmetic.bogus 1\n",
+        "bogus.insertion_limit 1\n",
+        "arithmetic 1\n",
+        "other.network_limit 9\n",
+    }) {
+        std::ofstream(path) << bad;
+        bool thrown = false;
+        try {
+            loadSortConfig(path, loaded);
+        } catch (const std::invalid_argument & error) {
+            thrown = std::string(error.what()).rfind("Line 1: ", 0) == 0;
+        }
+        assert(thrown);
+    }
+    std::remove(path.c_str());
+    assert(!loadSortConfig(path, loaded));
+
+    // Tune for this machine, and store the result the first time.
+    const SortConfig defaults;
+    const double tune_time = time([&]() {
+        initSortConfig(path);
+    });
+    std::remove(path.c_str());
+    std::cout << "Autotuning took " << tune_time << " s" << std::endl;
+    printThresholds("defaults   int", defaults.arithmetic);
+    printThresholds("defaults other", defaults.other);
+    printThresholds("tuned      int", config.arithmetic);
+    printThresholds("tuned    other", config.other);
+
+    // Test speed on many short lists, where thresholds matter most.
+    const SortConfig tuned = config;
+    printRow("n", "sort()", "defaults", "tuned");
+    for (long n : {8, 16, 32, 64, 128, 256, 1024, 10000}) {
+        const std::vector<int> lists = randomIntList(10000000 / n * n);
+        const auto tunedSort_lambda = [](auto front, auto back) {
+            tunedSort(front, back);
+        };
+
+        const double sort_time = timeManyLists(
+            lists, n, [](auto front, auto back) { std::sort(front, back); }
+        );
+
+        config = defaults;
+        const double default_time = timeManyLists(lists, n, tunedSort_lambda);
+
+        config = tuned;
+        const double tuned_time = timeManyLists(lists, n, tunedSort_lambda);
+
+        printRow(n, sort_time, default_time, tuned_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,444 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../libraries/sorting_network.hpp"
+#include "../insertion_sort/insertion_sort.hpp"
+#include "../merge_sort/merge_sort.hpp"
+#include "../pdq_sort/pdq_sort.hpp"
+#include "../shell_sort/shell_sort.hpp"
+
+
+/**
+ * The list lengths at which tunedSort() and tunedStableSort() switch between
+ * algorithms, for one kind of element type.
+ */
+struct SortThresholds {
+    /**
+     * Lists up to this long are sorted with a sorting network. At most 8.
+     */
+    long network_limit = 8;
+    /**
+     * Longer lists up to this long are sorted with insertion sort.
+     */
+    long insertion_limit = 24;
+    /**
+     * Longer lists up to this long are sorted with Shell sort, and longer
+     * ones with pattern-defeating quicksort.
+     */
+    long shell_limit = 24;
+    /**
+     * Lists up to this long are sorted with insertion sort when stability is
+     * required, and longer ones with merge sort. Merge sort also insertion
+     * sorts its parts up to this long.
+     */
+    long stable_insertion_limit = 5;
+};
+
+/**
+ * Thresholds for arithmetic types, which are cheap to compare and move, and
+ * for all other types.
+ */
+struct SortConfig {
+    SortThresholds arithmetic;
+    SortThresholds other;
+};
+
+
+namespace {
+
+/**
+ * The sizes at which autotuning compares algorithms, about 1.4 times apart.
+ */
+constexpr long autotune_sizes[] = {
+    2, 3, 4, 6, 8, 11, 16, 23, 32, 45, 64, 91, 128, 181, 256, 362, 512, 724,
+    1024, 1448, 2048,
+};
+
+/**
+ * About how many elements autotuning sorts to time one algorithm at one size.
+ */
+constexpr long autotune_elements = 1 << 16;
+
+/**
+ * Measures how long an algorithm takes to sort many lists of one size.
+ *
+ * @param lists Random lists of the size, one after another.
+ * @param size The size of each list.
+ * @param algorithm The sorting algorithm.
+ * @return The best time of a few runs, in seconds.
+ */
+template<class T>
+double timeSortOfSize(
+    const std::vector<T> & lists,
+    long size,
+    const std::function<void(
+        typename std::vector<T>::iterator, typename std::vector<T>::iterator
+    )> & algorithm
+) {
+    constexpr int runs = 3;
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        std::vector<T> work = lists;
+        const auto start = std::chrono::steady_clock::now();
+        for (auto front = work.begin(); front < work.end(); front += size) {
+            algorithm(front, front + size);
+        }
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+/**
+ * Finds the largest size up to which a simpler algorithm stays faster.
+ *
+ * Sizes are tried in increasing order until the simpler algorithm loses twice
+ * in a row, so that a single noisy measurement does not end the search.
+ *
+ * @param random_value A function which returns a random element.
+ * @param first_size The first size to compare at.
+ * @param last_size The last size to compare at.
+ * @param simple The simpler algorithm.
+ * @param fast The algorithm for longer lists.
+ * @return The largest tested size at which the simpler algorithm was faster,
+ * or first_size - 1 if there is none.
+ */
+template<class T>
+long findCrossover(
+    const std::function<T()> & random_value,
+    long first_size,
+    long last_size,
+    const std::function<void(
+        typename std::vector<T>::iterator, typename std::vector<T>::iterator
+    )> & simple,
+    const std::function<void(
+        typename std::vector<T>::iterator, typename std::vector<T>::iterator
+    )> & fast
+) {
+    constexpr int losses_allowed = 2;
+    long crossover = first_size - 1;
+    int losses = 0;
+    for (long size : autotune_sizes) {
+        if (size < first_size || size > last_size) {
+            continue;
+        }
+        const long count = std::max(1L, autotune_elements / size);
+        std::vector<T> lists(count * size);
+        std::generate(lists.begin(), lists.end(), random_value);
+
+        if (
+            timeSortOfSize(lists, size, simple)
+            <= timeSortOfSize(lists, size, fast)
+        ) {
+            crossover = size;
+            losses = 0;
+        } else if (++losses == losses_allowed) {
+            break;
+        }
+    }
+    return crossover;
+}
+
+/**
+ * Measures all thresholds for one element type.
+ *
+ * @param random_value A function which returns a random element.
+ * @return The thresholds.
+ */
+template<class T>
+SortThresholds autotuneThresholds(const std::function<T()> & random_value) {
+    using iterator = typename std::vector<T>::iterator;
+
+    const auto network = [](iterator front, iterator back) {
+        networkSort(front, back - front);
+    };
+    const auto insertion = [](iterator front, iterator back) {
+        insertionSort(front, back);
+    };
+    const auto shell = [](iterator front, iterator back) {
+        shellSort(front, back);
+    };
+    const auto pdq = [](iterator front, iterator back) {
+        pdqSort(front, back);
+    };
+    const auto merge = [](iterator front, iterator back) {
+        mergeSort(front, back);
+    };
+    constexpr long max_size =
+        autotune_sizes[sizeof(autotune_sizes) / sizeof(long) - 1];
+
+    SortThresholds thresholds;
+    thresholds.network_limit = findCrossover<T>(
+        random_value, 2, network_sort_limit, network, insertion
+    );
+    // Shorter lists are all insertion sorted by pdqSort() too, so comparing
+    // there would only measure noise.
+    thresholds.insertion_limit = findCrossover<T>(
+        random_value,
+        std::max(thresholds.network_limit + 1, pdq_insertion_sort_threshold),
+        max_size,
+        insertion,
+        pdq
+    );
+    thresholds.shell_limit = findCrossover<T>(
+        random_value, thresholds.insertion_limit + 1, max_size, shell, pdq
+    );
+    thresholds.stable_insertion_limit =
+        findCrossover<T>(random_value, 2, max_size, insertion, merge);
+    return thresholds;
+}
+
+/**
+ * Selects the thresholds for an element type.
+ */
+template<class T>
+const SortThresholds & thresholdsFor(const SortConfig & config) {
+    return std::is_arithmetic<T>::value ? config.arithmetic : config.other;
+}
+
+} // namespace
+
+
+/**
+ * The thresholds used by tunedSort() and tunedStableSort().
+ *
+ * They start with built-in defaults. Replace them at startup, before any
+ * threads sort, for example with loadSortConfig() or autotuneSortConfig().
+ *
+ * @return The thresholds, shared by the whole program.
+ */
+inline SortConfig & sortConfig(void) {
+    static SortConfig config;
+    return config;
+}
+
+/**
+ * Sorts a list, choosing the algorithm by the element type and list length.
+ *
+ * The shortest lists are sorted with sorting networks, short lists with
+ * insertion sort, medium lists with Shell sort and long lists with
+ * pattern-defeating quicksort. The lengths at which the algorithm changes come
+ * from sortConfig(), separately for arithmetic types and other types. The sort
+ * is not stable.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @see tunedStableSort(RandAccessIterator, RandAccessIterator)
+ */
+template<class RandAccessIterator>
+void tunedSort(RandAccessIterator front, RandAccessIterator back) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const SortThresholds & thresholds =
+        thresholdsFor<value_type>(sortConfig());
+    const auto length = back - front;
+    if (length <= std::min<long>(
+        thresholds.network_limit, network_sort_limit
+    )) {
+        networkSort(front, length);
+    } else if (length <= thresholds.insertion_limit) {
+        insertionSort(front, back);
+    } else if (length <= thresholds.shell_limit) {
+        shellSort(front, back);
+    } else {
+        pdqSort(front, back);
+    }
+}
+
+/**
+ * Sorts a list stably, choosing the algorithm by the element type and list
+ * length.
+ *
+ * Short lists are sorted with insertion sort and longer lists with merge sort,
+ * which hands its short parts to insertion sort at the same length.
+ *
+ * @param front A random access iterator to the front of the list.
+ * @param back A random access iterator to the back of the list.
+ * @see tunedSort(RandAccessIterator, RandAccessIterator)
+ */
+template<class RandAccessIterator>
+void tunedStableSort(RandAccessIterator front, RandAccessIterator back) {
+    using value_type =
+            typename std::iterator_traits<RandAccessIterator>::value_type;
+
+    const SortThresholds & thresholds =
+        thresholdsFor<value_type>(sortConfig());
+    if (back - front <= thresholds.stable_insertion_limit) {
+        insertionSort(front, back);
+    } else {
+        auto buffer = new value_type[back - front];
+        bufferedMergeSort(
+            front, back, buffer, thresholds.stable_insertion_limit
+        );
+        delete[] buffer;
+    }
+}
+
+/**
+ * Measures the crossover points between the sorting algorithms on this
+ * machine.
+ *
+ * Each pair of algorithms sorts many random lists of increasing sizes, until
+ * the simpler one is no longer faster. Arithmetic types are measured with
+ * ints, and other types with short strings. This takes about a second.
+ *
+ * @return The measured thresholds.
+ */
+inline SortConfig autotuneSortConfig(void) {
+    std::default_random_engine r_engine;
+    std::uniform_int_distribution<int> r_int;
+    std::uniform_int_distribution<int> r_char('a', 'z');
+
+    SortConfig config;
+    config.arithmetic = autotuneThresholds<int>([&]() {
+        return r_int(r_engine);
+    });
+    config.other = autotuneThresholds<std::string>([&]() {
+        std::string value(12, ' ');
+        for (auto & character : value) {
+            character = r_char(r_engine);
+        }
+        return value;
+    });
+    return config;
+}
+
+/**
+ * Writes thresholds to a config file.
+ *
+ * Each line holds a name and a value, such as "arithmetic.insertion_limit 24".
+ *
+ * @param path The file path.
+ * @param config The thresholds.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+inline void saveSortConfig(
+    const std::string & path, const SortConfig & config
+) {
+    std::ofstream file(path);
+    const std::pair<const char *, const SortThresholds *> kinds[] = {
+        {"arithmetic", &config.arithmetic},
+        {"other", &config.other},
+    };
+    for (const auto & kind : kinds) {
+        file << kind.first << ".network_limit "
+            << kind.second->network_limit << '\n'
+            << kind.first << ".insertion_limit "
+            << kind.second->insertion_limit << '\n'
+            << kind.first << ".shell_limit "
+            << kind.second->shell_limit << '\n'
+            << kind.first << ".stable_insertion_limit "
+            << kind.second->stable_insertion_limit << '\n';
+    }
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+/**
+ * Reads thresholds from a config file written by saveSortConfig().
+ *
+ * Blank lines and lines starting with '#' are ignored. Thresholds which are
+ * missing from the file keep their built-in defaults.
+ *
+ * @param path The file path.
+ * @param config Where to store the thresholds.
+ * @return Whether the file could be opened.
+ * @throws std::invalid_argument If a line is not a known name and a number.
+ */
+inline bool loadSortConfig(const std::string & path, SortConfig & config) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    SortConfig loaded;
+    std::string line;
+    for (long line_number = 1; std::getline(file, line); ++line_number) {
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name) || name[0] == '#') {
+            continue;
+        }
+
+        const auto dot = name.find('.');
+        SortThresholds * thresholds = nullptr;
+        if (name.compare(0, dot, "arithmetic") == 0) {
+            thresholds = &loaded.arithmetic;
+        } else if (name.compare(0, dot, "other") == 0) {
+            thresholds = &loaded.other;
+        }
+
+        const std::string field =
+            dot == std::string::npos ? "" : name.substr(dot + 1);
+        long * value = nullptr;
+        if (thresholds == nullptr) {
+            // Leave value null.
+        } else if (field == "network_limit") {
+            value = &thresholds->network_limit;
+        } else if (field == "insertion_limit") {
+            value = &thresholds->insertion_limit;
+        } else if (field == "shell_limit") {
+            value = &thresholds->shell_limit;
+        } else if (field == "stable_insertion_limit") {
+            value = &thresholds->stable_insertion_limit;
+        }
+        if (value == nullptr) {
+            throw std::invalid_argument(
+                "Line " + std::to_string(line_number)
+                + ": Unknown threshold " + name
+            );
+        }
+
+        std::string extra;
+        if (!(fields >> *value) || fields >> extra) {
+            throw std::invalid_argument(
+                "Line " + std::to_string(line_number)
+                + ": Expected one number after " + name
+            );
+        }
+        if (
+            value == &thresholds->network_limit
+            && *value > static_cast<long>(network_sort_limit)
+        ) {
+            throw std::invalid_argument(
+                "Line " + std::to_string(line_number) + ": " + name
+                + " must be at most " + std::to_string(network_sort_limit)
+            );
+        }
+    }
+
+    config = loaded;
+    return true;
+}
+
+/**
+ * Sets up sortConfig() at startup.
+ *
+ * The thresholds are loaded from a config file. If there is no file yet, they
+ * are measured with autotuneSortConfig() and saved for the next start.
+ *
+ * @param path The config file path.
+ */
+inline void initSortConfig(const std::string & path) {
+    if (!loadSortConfig(path, sortConfig())) {
+        sortConfig() = autotuneSortConfig();
+        saveSortConfig(path, sortConfig());
+    }
+}